@@ -0,0 +1,64 @@
+/**
+ * @file ADC.h
+ * @brief Teensy ADC library compatibility shim for native Linux builds
+ *
+ * Records the configuration the firmware applies. Conversions are
+ * simulated by AnalogBufferDMA.h using analogRead().
+ */
+
+#ifndef ADC_H
+#define ADC_H
+
+#include "Arduino.h"
+
+#define ADC_0 0
+#define ADC_1 1
+
+enum class ADC_CONVERSION_SPEED : uint8_t {
+    VERY_LOW_SPEED, LOW_SPEED, MED_SPEED, HIGH_SPEED, VERY_HIGH_SPEED
+};
+
+enum class ADC_SAMPLING_SPEED : uint8_t {
+    VERY_LOW_SPEED, LOW_SPEED, MED_SPEED, HIGH_SPEED, VERY_HIGH_SPEED
+};
+
+/**
+ * @brief One ADC converter (ADC1/ADC2 on Teensy 4.1)
+ */
+class ADC_Module {
+public:
+    ADC_Module() : _pin(0), _timerFreq(0) {}
+
+    void setResolution(uint8_t) {}
+    void setAveraging(uint8_t) {}
+    void setConversionSpeed(ADC_CONVERSION_SPEED) {}
+    void setSamplingSpeed(ADC_SAMPLING_SPEED) {}
+
+    bool startSingleRead(uint8_t pin) { _pin = pin; return true; }
+    void startTimer(uint32_t freq) { _timerFreq = freq; }
+    void stopTimer() { _timerFreq = 0; }
+
+    // Simulation accessors
+    uint8_t pin() const { return _pin; }
+    uint32_t timerFreq() const { return _timerFreq; }
+
+private:
+    std::atomic<uint8_t> _pin;
+    std::atomic<uint32_t> _timerFreq;
+};
+
+/**
+ * @brief ADC library entry point
+ */
+class ADC {
+public:
+    ADC() : adc0(&_modules[0]), adc1(&_modules[1]) {}
+
+    ADC_Module* const adc0;
+    ADC_Module* const adc1;
+
+private:
+    ADC_Module _modules[2];
+};
+
+#endif // ADC_H
@@ -0,0 +1,84 @@
+/**
+ * @file AnalogBufferDMA.h
+ * @brief Teensy AnalogBufferDMA compatibility shim for native Linux builds
+ *
+ * A simulation thread fills the two buffers alternately at the ADC timer
+ * rate using analogRead(), then raises the same "interrupt" flags and
+ * counters as the DMA completion ISR on Teensy.
+ */
+
+#ifndef ANALOG_BUFFER_DMA_H
+#define ANALOG_BUFFER_DMA_H
+
+#include "Arduino.h"
+#include "ADC.h"
+
+class AnalogBufferDMA {
+public:
+    AnalogBufferDMA(volatile uint16_t* buffer1, uint16_t buffer1_count,
+                    volatile uint16_t* buffer2 = nullptr, uint16_t buffer2_count = 0)
+        : _buffers{buffer1, buffer2}, _counts{buffer1_count, buffer2_count},
+          _module(nullptr), _running(false), _lastFilled(0),
+          _interruptFired(false), _interruptCount(0) {}
+
+    ~AnalogBufferDMA() {
+        _running = false;
+        if (_thread.joinable()) _thread.join();
+    }
+
+    void init(ADC* adc, int8_t adc_num = ADC_0) {
+        _module = (adc_num == ADC_1) ? adc->adc1 : adc->adc0;
+        if (_running) return;
+        _running = true;
+        _thread = std::thread([this]() { run(); });
+    }
+
+    bool interrupted() { return _interruptFired; }
+    void clearInterrupt() { _interruptFired = false; }
+    uint32_t interruptCount() { return _interruptCount; }
+
+    volatile uint16_t* bufferLastISRFilled() { return _buffers[_lastFilled]; }
+    uint16_t bufferCountLastISRFilled() { return _counts[_lastFilled]; }
+
+private:
+    volatile uint16_t* _buffers[2];
+    uint16_t _counts[2];
+    ADC_Module* _module;
+
+    std::atomic<bool> _running;
+    std::atomic<int> _lastFilled;
+    std::atomic<bool> _interruptFired;
+    std::atomic<uint32_t> _interruptCount;
+    std::thread _thread;
+
+    void run() {
+        int active = 0;
+        size_t index = 0;
+        auto next = std::chrono::steady_clock::now();
+
+        while (_running) {
+            uint32_t freq = _module->timerFreq();
+            if (freq == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                next = std::chrono::steady_clock::now();
+                continue;
+            }
+
+            next += std::chrono::nanoseconds(1000000000ULL / freq);
+            std::this_thread::sleep_until(next);
+
+            _buffers[active][index++] = (uint16_t)analogRead(_module->pin());
+            if (index < _counts[active]) continue;
+
+            // Buffer complete - "DMA interrupt"
+            _lastFilled = active;
+            _interruptCount++;
+            _interruptFired = true;
+
+            index = 0;
+            if (_buffers[1]) active ^= 1;
+        }
+    }
+};
+
+#endif // ANALOG_BUFFER_DMA_H
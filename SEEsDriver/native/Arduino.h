@@ -15,13 +15,31 @@
 #include <string>
 #include <chrono>
 #include <thread>
+#include <atomic>
 #include <new>
 
 // Arduino type aliases
 using byte = uint8_t;
 
+// Memory placement / cache maintenance (no-ops on Linux)
+#define DMAMEM
+#define EXTMEM
+inline void arm_dcache_delete(void*, uint32_t) {}
+
+// External PSRAM (Teensy 4.1 extmem_malloc). Served from a separate
+// arena so the second storage tier is exercised natively.
+#ifndef NATIVE_PSRAM_MB
+#define NATIVE_PSRAM_MB 8
+#endif
+extern uint8_t external_psram_size;  // MB, as set by the Teensy startup code
+void* extmem_malloc(size_t size);
+void extmem_free(void* ptr);
+
 // Pin definitions (no-ops on Linux)
 #define A0 0
+#define A1 1
+#define A2 2
+#define A3 3
 #define BUILTIN_SDCARD 0
 #define INPUT 0
 #define OUTPUT 1
@@ -61,6 +79,45 @@ inline void analogReadAveraging(int) {}
 // Forward declaration - implemented in main_native.cpp
 int analogRead(uint8_t pin);
 
+/**
+ * @brief Teensy IntervalTimer compatibility
+ *
+ * Runs the callback from a high-resolution timer thread at a fixed period,
+ * standing in for the hardware timer interrupt.
+ */
+class IntervalTimer {
+public:
+    IntervalTimer() : _running(false) {}
+    ~IntervalTimer() { end(); }
+
+    bool begin(void (*callback)(), uint32_t periodUs) {
+        end();
+        if (!callback || periodUs == 0) return false;
+        _running = true;
+        _thread = std::thread([this, callback, periodUs]() {
+            auto next = std::chrono::steady_clock::now();
+            const auto period = std::chrono::microseconds(periodUs);
+            while (_running) {
+                next += period;
+                std::this_thread::sleep_until(next);
+                callback();
+            }
+        });
+        return true;
+    }
+
+    void end() {
+        _running = false;
+        if (_thread.joinable()) _thread.join();
+    }
+
+    void priority(uint8_t) {}
+
+private:
+    std::atomic<bool> _running;
+    std::thread _thread;
+};
+
 /**
  * @brief Arduino String class compatibility
  */
@@ -143,6 +200,9 @@ public:
     void println(float val, int decimals = 2) { printf("%.*f\n", decimals, val); fflush(stdout); }
     void println(double val, int decimals = 2) { printf("%.*f\n", decimals, val); fflush(stdout); }
 
+    size_t write(uint8_t b) { size_t n = fwrite(&b, 1, 1, stdout); fflush(stdout); return n; }
+    size_t write(const uint8_t* buf, size_t size) { size_t n = fwrite(buf, 1, size, stdout); fflush(stdout); return n; }
+
     // Input functions - implemented in main_native.cpp
     bool available();
     String readStringUntil(char terminator);
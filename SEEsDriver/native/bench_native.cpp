@@ -0,0 +1,256 @@
+/**
+ * @file bench_native.cpp
+ * @brief Native benchmarks for the per-sample hot path
+ *
+ * Build and run with `make bench`. Each benchmark first checks that the
+ * optimized code makes exactly the decisions of the code it replaces,
+ * then reports the cost per sample.
+ *
+ * detect: integer-count SEEs_Detector vs the float-volt detector
+ *         SEEs_ADC used before (same thresholds as SEEs_ADC), plus the
+ *         cost of baseline-relative mode ("set baseline 1")
+ * filter: FIR shaping (SEEs_Filter) vs a direct convolution, and its
+ *         cost per sample as a share of the sample period at 10, 50 and
+ *         100 kS/s, for several tap counts
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#endif
+
+#include "../src/SEEs_Detect.hpp"
+#include "../src/SEEs_Filter.hpp"
+
+// SEEs_ADC detection constants
+static constexpr int ADC_BITS = 12;
+static constexpr float ADC_VREF = 3.3f;
+static constexpr uint16_t ADC_MAX = (1UL << ADC_BITS) - 1UL;
+static constexpr float VOLTS_PER_COUNT = ADC_VREF / ADC_MAX;
+static constexpr float LOWER_ENTER_V = 0.30f;
+static constexpr float LOWER_EXIT_V = 0.300f;
+static constexpr float UPPER_LIMIT_V = 0.800f;
+static constexpr uint32_t REFRACT_US = 300;
+static constexpr uint32_t SAMPLE_US = 100;
+
+static const SEEsThresholds kThresholds = {
+    sees_counts_at_least(LOWER_ENTER_V, VOLTS_PER_COUNT, ADC_MAX),
+    (uint16_t)(sees_counts_above(UPPER_LIMIT_V, VOLTS_PER_COUNT, ADC_MAX) - 1),
+    sees_counts_at_least(LOWER_EXIT_V, VOLTS_PER_COUNT, ADC_MAX),
+    REFRACT_US,
+    0,
+    0,
+};
+
+/**
+ * @brief The float detector SEEs_ADC::processSample() ran per sample
+ */
+class FloatDetector {
+public:
+    explicit FloatDetector(float voltsPerCount)
+        : _voltsPerCount(voltsPerCount), _armed(true), _lastHitUs(0) {}
+
+    SEEs_Detector::Step step(uint16_t raw, uint32_t now_us) {
+        float v = raw * _voltsPerCount;
+        if (_armed) {
+            if (v >= LOWER_ENTER_V && v <= UPPER_LIMIT_V &&
+                (now_us - _lastHitUs) >= REFRACT_US) {
+                _lastHitUs = now_us;
+                _armed = false;
+                return SEEs_Detector::Step::Hit;
+            }
+            return SEEs_Detector::Step::Armed;
+        }
+        if (v < LOWER_EXIT_V) {
+            _armed = true;
+            return SEEs_Detector::Step::Rearm;
+        }
+        return SEEs_Detector::Step::Pulse;
+    }
+
+private:
+    float _voltsPerCount;
+    bool _armed;
+    uint32_t _lastHitUs;
+};
+
+// Baseline noise with pulses of random height and width (xorshift, fixed seed)
+static std::vector<uint16_t> makeStream(size_t n) {
+    std::vector<uint16_t> out(n);
+    uint32_t x = 2463534242u;
+    auto rnd = [&x]() { x ^= x << 13; x ^= x >> 17; x ^= x << 5; return x; };
+
+    size_t i = 0;
+    while (i < n) {
+        uint32_t gap = rnd() % 200;
+        for (uint32_t k = 0; k < gap && i < n; k++) out[i++] = 100 + rnd() % 60;
+        uint32_t height = 300 + rnd() % 1200;
+        uint32_t width = 1 + rnd() % 20;
+        for (uint32_t k = 0; k < width && i < n; k++) {
+            out[i++] = (uint16_t)(height - height * k / (width + 1) + rnd() % 16);
+        }
+    }
+    return out;
+}
+
+static double nowNs() {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t ticks() {
+#ifdef BENCH_HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+template <typename Step>
+static void timeDetector(const char* name, const std::vector<uint16_t>& stream, int passes, Step step) {
+    uint32_t hits = 0;
+    uint32_t t = 0;
+    double t0 = nowNs();
+    uint64_t c0 = ticks();
+    for (int p = 0; p < passes; p++) {
+        for (uint16_t raw : stream) {
+            hits += step(raw, t) == SEEs_Detector::Step::Hit;
+            t += SAMPLE_US;
+        }
+    }
+    uint64_t c1 = ticks();
+    double t1 = nowNs();
+
+    double samples = (double)stream.size() * passes;
+    printf("  %-8s %6.2f ns/sample", name, (t1 - t0) / samples);
+#ifdef BENCH_HAVE_TSC
+    printf("  %6.2f TSC ticks/sample", (c1 - c0) / samples);
+#else
+    (void)c0; (void)c1;
+#endif
+    printf("  (%u hits)\n", hits);
+}
+
+static bool benchDetect() {
+    printf("detect: thresholds enter %u, upper %u, exit %u counts\n",
+           kThresholds.enter_adc, kThresholds.upper_adc, kThresholds.exit_adc);
+
+    // The float scale as SEEs_ADC computed it at run time
+    volatile float vref = ADC_VREF;
+    float voltsPerCount = vref / ADC_MAX;
+
+    // Every ADC count takes the same branch
+    for (uint32_t raw = 0; raw <= ADC_MAX; raw++) {
+        float v = raw * voltsPerCount;
+        bool enter = raw >= kThresholds.enter_adc && raw <= kThresholds.upper_adc;
+        bool exit = raw < kThresholds.exit_adc;
+        if (enter != (v >= LOWER_ENTER_V && v <= UPPER_LIMIT_V) || exit != (v < LOWER_EXIT_V)) {
+            printf("  FAIL: count %u decides differently\n", raw);
+            return false;
+        }
+    }
+
+    // Identical decisions over a long stream (refractory and hysteresis included)
+    std::vector<uint16_t> stream = makeStream(1u << 20);
+    SEEs_Detector integer;
+    FloatDetector reference(voltsPerCount);
+    uint32_t t = 0;
+    for (size_t i = 0; i < stream.size(); i++, t += SAMPLE_US) {
+        if (integer.step(stream[i], t, kThresholds) != reference.step(stream[i], t)) {
+            printf("  FAIL: sample %zu decides differently\n", i);
+            return false;
+        }
+    }
+    printf("  decisions identical for all %u counts and %zu stream samples\n",
+           ADC_MAX + 1, stream.size());
+
+    const int passes = 50;
+    SEEs_Detector timedInteger;
+    FloatDetector timedFloat(voltsPerCount);
+    timeDetector("float", stream, passes,
+                 [&](uint16_t raw, uint32_t now) { return timedFloat.step(raw, now); });
+    timeDetector("integer", stream, passes,
+                 [&](uint16_t raw, uint32_t now) { return timedInteger.step(raw, now, kThresholds); });
+
+    // Offsets above a ~130-count baseline, with a 5 sigma floor
+    SEEsThresholds relative = {240, 860, 240, REFRACT_US, 1, 50};
+    SEEs_Detector timedRelative;
+    timeDetector("relative", stream, passes,
+                 [&](uint16_t raw, uint32_t now) { return timedRelative.step(raw, now, relative); });
+    return true;
+}
+
+// Direct convolution, history before the first sample held at its value
+template <size_t TAPS>
+static bool checkFilter(const std::vector<uint16_t>& stream, SEEsFilterShape shape) {
+    SEEs_FirKernel<TAPS> kernel = SEEs_FirKernel<TAPS>::make(shape);
+    SEEs_FirFilter<TAPS> filter;
+    for (size_t i = 0; i < stream.size(); i++) {
+        int32_t acc = 1 << (SEEs_FirKernel<TAPS>::Q - 1);
+        for (size_t k = 0; k < TAPS; k++) acc += kernel.c[k] * (int32_t)stream[i >= k ? i - k : 0];
+        acc >>= SEEs_FirKernel<TAPS>::Q;
+        uint16_t expect = acc < 0 ? 0 : acc > ADC_MAX ? ADC_MAX : (uint16_t)acc;
+        if (filter.push(stream[i], kernel, ADC_MAX) != expect) {
+            printf("  FAIL: %zu taps, sample %zu differs from the direct convolution\n", TAPS, i);
+            return false;
+        }
+    }
+    return true;
+}
+
+template <size_t TAPS>
+static void timeFilter(const std::vector<uint16_t>& stream, int passes) {
+    SEEs_FirKernel<TAPS> kernel = SEEs_FirKernel<TAPS>::make(SEEsFilterShape::Trapezoid);
+    SEEs_FirFilter<TAPS> filter;
+    uint32_t sum = 0;
+    double t0 = nowNs();
+    for (int p = 0; p < passes; p++) {
+        for (uint16_t raw : stream) sum += filter.push(raw, kernel, ADC_MAX);
+    }
+    double ns = (nowNs() - t0) / ((double)stream.size() * passes);
+
+    // Share of the sample period spent filtering one layer
+    printf("  %2zu taps %6.2f ns/sample  load %.4f%% / %.4f%% / %.4f%%  (sum %u)\n", TAPS, ns,
+           ns / 1e5 * 100, ns / 2e4 * 100, ns / 1e4 * 100, sum);
+}
+
+static bool benchFilter() {
+    printf("filter: Q%u FIR, load at 10 / 50 / 100 kS/s per layer\n", SEEs_FirKernel<8>::Q);
+
+    std::vector<uint16_t> stream = makeStream(1u << 20);
+    if (!checkFilter<4>(stream, SEEsFilterShape::Box) || !checkFilter<8>(stream, SEEsFilterShape::Box) ||
+        !checkFilter<8>(stream, SEEsFilterShape::Trapezoid) ||
+        !checkFilter<16>(stream, SEEsFilterShape::Trapezoid) ||
+        !checkFilter<SEES_FILTER_TAPS>(stream, SEEsFilterShape::Off)) {
+        return false;
+    }
+
+    // Unity DC gain: a flat input comes out unchanged
+    SEEs_FirKernel<16> trap = SEEs_FirKernel<16>::make(SEEsFilterShape::Trapezoid);
+    SEEs_FirFilter<16> flat;
+    for (uint32_t raw = 0; raw <= ADC_MAX; raw += 63) {
+        flat.reset();
+        if (flat.push((uint16_t)raw, trap, ADC_MAX) != raw) {
+            printf("  FAIL: flat input %u is not passed through\n", raw);
+            return false;
+        }
+    }
+    printf("  output identical to the direct convolution for %zu stream samples\n", stream.size());
+
+    const int passes = 20;
+    timeFilter<4>(stream, passes);
+    timeFilter<8>(stream, passes);
+    timeFilter<16>(stream, passes);
+    timeFilter<32>(stream, passes);
+    return true;
+}
+
+int main() {
+    bool ok = benchDetect();
+    ok = benchFilter() && ok;
+    return ok ? 0 : 1;
+}
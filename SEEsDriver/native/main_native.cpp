@@ -8,6 +8,8 @@
  * - Serial output goes to stdout
  * - Serial input comes from stdin
  *
+ * - IntervalTimer runs its callback from a timer thread
+ *
  * This ensures the simulation tests the EXACT SAME firmware code
  * that runs on the Teensy hardware.
  */
@@ -29,6 +31,27 @@
 // Global instances required by shims
 SerialClass Serial;
 
+// Emulated PSRAM: bump allocator over its own arena, reset once all
+// blocks are freed
+uint8_t external_psram_size = NATIVE_PSRAM_MB;
+static uint8_t g_psram[NATIVE_PSRAM_MB * 1024UL * 1024UL] __attribute__((aligned(32)));
+static size_t g_psramUsed = 0;
+static size_t g_psramLive = 0;
+
+void* extmem_malloc(size_t size) {
+    size = (size + 31) & ~(size_t)31;
+    if (size > sizeof(g_psram) - g_psramUsed) return nullptr;
+    void* p = g_psram + g_psramUsed;
+    g_psramUsed += size;
+    g_psramLive++;
+    return p;
+}
+
+void extmem_free(void* ptr) {
+    if (!ptr) return;
+    if (--g_psramLive == 0) g_psramUsed = 0;
+}
+
 // Simulation state
 static std::atomic<bool> g_running(true);
 static std::atomic<float> g_currentVoltage(0.0f);
@@ -95,9 +118,20 @@ void dataReaderThread(const char* dataPort) {
 
 /**
  * @brief analogRead() - returns simulated ADC counts from data stream
+ *
+ * Pins A0..A3 are the four layers of the stack. The stream carries layer 0;
+ * deeper layers see the pulse attenuated so it crosses the 0.30 V trigger
+ * only when its amplitude means the particle got that far (the per-layer
+ * amplitudes of tests/test_data_generator.py).
  */
-int analogRead(uint8_t) {
+int analogRead(uint8_t pin) {
+    static const float kLayerGain[4] = {1.0f, 0.615f, 0.421f, 0.320f};
+    static const float kBaselineV = 0.1f;
+
     float voltage = g_currentVoltage;
+    if (pin > 0 && pin < 4) {
+        voltage = kBaselineV + (voltage - kBaselineV) * kLayerGain[pin];
+    }
     int counts = (int)((voltage / 3.3f) * 4095.0f);
     if (counts < 0) counts = 0;
     if (counts > 4095) counts = 4095;
@@ -139,7 +173,21 @@ String SerialClass::readStringUntil(char terminator) {
 // ============================================================================
 // Include the ACTUAL firmware source files
 // ============================================================================
+#include "../src/SampleCodec.hpp"
+#include "../src/SampleCodec.cpp"
+#include "../src/SEEs_Channels.hpp"
 #include "../src/SampleBuffer.hpp"
+#include "../src/SEEs_Interface.hpp"
+#include "../src/SEEs_Interface.cpp"
+#include "../src/SEEs_Acquisition.hpp"
+#include "../src/SEEs_Acquisition.cpp"
+#include "../src/SEEs_Coincidence.hpp"
+#include "../src/SEEs_Coincidence.cpp"
+#include "../src/SEEs_Histogram.hpp"
+#include "../src/SEEs_Histogram.cpp"
+#include "../src/SEEs_Pulse.hpp"
+#include "../src/SEEs_Detect.hpp"
+#include "../src/SEEs_Filter.hpp"
 #include "../src/SEEs_ADC.hpp"
 #include "../src/SEEs_ADC.cpp"
 
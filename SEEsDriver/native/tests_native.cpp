@@ -0,0 +1,365 @@
+/**
+ * @file tests_native.cpp
+ * @brief Native unit tests for the sample buffer and pulse records
+ *
+ * Build and run with `make test`. Every storage layout (SoA, AoS, packed,
+ * compressed, tiered) is driven through SampleBufferT with the same stream
+ * and checked against a reference copy of it. The stream mixes blocks of
+ * every length, single samples, gaps of up to 40 ms, a few gaps too long
+ * for a 16-bit delta (long-gap markers), several ring wraps and a micros()
+ * wrap. At checkpoints the tests compare:
+ *
+ *   timeOf()        - every retained sample
+ *   seqAtOrAfter()  - at, just before and just after sample times, and
+ *                     outside the retained window
+ *   countHits()     - random windows, including ones reaching past the ends
+ *   findHit()       - every indexed hit (time and ADC value)
+ *
+ * Each layout runs with a power-of-two capacity (masked wrap) and one that
+ * is not a multiple of any block size.
+ *
+ * The tiered layout's stall count (hot ring full, block flushed inline)
+ * is checked with service() withheld and then running, and the implied-
+ * timing layouts' count of time corrections they had no room to keep.
+ *
+ * pulse: SEEs_Detector and SEEs_Pulse driven in SEEs_ADC::processSample()
+ * order; every record's pedestal must be the sample before its hit.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "Arduino.h"
+
+SerialClass Serial;
+
+// PSRAM for the tiered layout: plain heap memory is enough here
+uint8_t external_psram_size = NATIVE_PSRAM_MB;
+void* extmem_malloc(size_t size) { return malloc(size); }
+void extmem_free(void* ptr) { free(ptr); }
+
+#include "../src/SampleCodec.hpp"
+#include "../src/SampleCodec.cpp"
+#include "../src/SampleBuffer.hpp"
+#include "../src/SEEs_Detect.hpp"
+#include "../src/SEEs_Pulse.hpp"
+
+static constexpr uint32_t RATE_HZ = 10000;
+static constexpr uint32_t SAMPLE_US = 1000000UL / RATE_HZ;
+
+struct RefSample {
+    uint32_t t;
+    uint16_t adc;
+    uint8_t hit;
+};
+
+/**
+ * @brief Reference copy of everything written, indexed by sequence number
+ */
+struct Reference {
+    std::vector<RefSample> samples;
+    std::vector<uint32_t> hitSeqs;  // hit number h is hitSeqs[h - 1]
+};
+
+static uint32_t g_rng = 0x2545F491;
+
+static uint32_t rnd() {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+static int g_failures = 0;
+
+#define CHECK(cond, ...)                               \
+    do {                                               \
+        if (!(cond)) {                                 \
+            if (g_failures++ < 10) {                   \
+                printf("  FAIL %s:%d: ", __FILE__, __LINE__); \
+                printf(__VA_ARGS__);                   \
+                printf("\n");                          \
+            }                                          \
+        }                                              \
+    } while (0)
+
+template <typename Buffer>
+static void checkContents(const Buffer& buf, const Reference& ref, bool fullRing) {
+    const std::vector<RefSample>& s = ref.samples;
+    uint32_t written = (uint32_t)s.size();
+    uint32_t held = (uint32_t)buf.size();
+    uint32_t oldest = written - held;
+
+    uint32_t expected = written < Buffer::TOTAL_SAMPLES ? written : (uint32_t)Buffer::TOTAL_SAMPLES;
+    if (fullRing) {
+        CHECK(held == expected, "holds %u samples, expected %u", held, expected);
+    } else {
+        CHECK(held > 0 && held <= expected, "holds %u samples, at most %u expected", held, expected);
+    }
+    if (held == 0) return;
+    CHECK(buf.lastSampleUs() == s.back().t, "newest sample at %u, expected %u",
+          buf.lastSampleUs(), s.back().t);
+
+    for (uint32_t q = oldest; q != written; q++) {
+        uint32_t t = buf.timeOf(q);
+        CHECK(t == s[q].t, "timeOf(%u) = %u, expected %u", q, t, s[q].t);
+    }
+
+    for (uint32_t q = oldest; q < written; q += 1 + rnd() % 61) {
+        uint32_t at = buf.seqAtOrAfter(s[q].t);
+        uint32_t before = buf.seqAtOrAfter(s[q].t - 1);
+        uint32_t after = buf.seqAtOrAfter(s[q].t + 1);
+        CHECK(at == q, "seqAtOrAfter(t[%u]) = %u", q, at);
+        CHECK(before == q, "seqAtOrAfter(t[%u] - 1) = %u", q, before);
+        CHECK(after == q + 1, "seqAtOrAfter(t[%u] + 1) = %u", q, after);
+    }
+    CHECK(buf.seqAtOrAfter(s[oldest].t - 100000) == oldest, "window start before the oldest sample");
+    CHECK(buf.seqAtOrAfter(s.back().t + 1) == written, "window start after the newest sample");
+
+    // Hit index: exactly the hits still in the ring, oldest first
+    uint32_t firstHit = 1;
+    while (firstHit <= ref.hitSeqs.size() && ref.hitSeqs[firstHit - 1] < oldest) firstHit++;
+    CHECK(buf.firstHit() == firstHit, "first indexed hit %u, expected %u", buf.firstHit(), firstHit);
+    CHECK(buf.totalHits() == ref.hitSeqs.size(), "%u hits recorded, expected %zu",
+          buf.totalHits(), ref.hitSeqs.size());
+
+    for (uint32_t h = buf.firstHit(); h < buf.firstHit() + buf.heldHits(); h++) {
+        uint32_t t = 0;
+        uint16_t adc = 0;
+        const RefSample& r = s[ref.hitSeqs[h - 1]];
+        bool found = buf.findHit(h, t, adc);
+        CHECK(found && t == r.t && adc == r.adc, "hit %u: found %d at %u adc %u, expected %u adc %u",
+              h, found, t, adc, r.t, r.adc);
+    }
+    uint32_t t = 0;
+    uint16_t adc = 0;
+    CHECK(!buf.findHit(buf.firstHit() - 1, t, adc) || buf.firstHit() == 1, "evicted hit still found");
+    CHECK(!buf.findHit(buf.totalHits() + 1, t, adc), "future hit found");
+
+    for (int k = 0; k < 50; k++) {
+        uint32_t a = oldest + rnd() % held;
+        uint32_t b = a + rnd() % (written - a);
+        uint32_t tStart = s[a].t - (k % 5 == 0 ? 50000 : 0);  // some reach past the oldest
+        uint32_t tEnd = s[b].t + (k % 7 == 0 ? 50000 : 0);    // or the newest sample
+        uint32_t expectedHits = 0;
+        for (uint32_t q = oldest; q != written; q++) {
+            if (s[q].hit && (int32_t)(s[q].t - tStart) >= 0 && (int32_t)(s[q].t - tEnd) <= 0) {
+                expectedHits++;
+            }
+        }
+        uint32_t counted = buf.countHits(tStart, tEnd);
+        CHECK(counted == expectedHits, "countHits(%u, %u) = %u, expected %u",
+              tStart, tEnd, counted, expectedHits);
+    }
+}
+
+/**
+ * @brief Write the test stream into a fresh buffer, checking as it fills
+ */
+template <typename Storage, size_t Capacity>
+static void testLayout(bool fullRing) {
+    using Buffer = SampleBufferT<RATE_HZ, 1, Storage, Capacity>;
+    Buffer* buf = new Buffer();
+    int before = g_failures;
+    g_rng = 0x2545F491;
+
+    Reference ref;
+    CHECK(buf->begin(), "allocation failed");
+
+    uint32_t t = 0xFFFF0000UL;  // micros() wraps after ~650 samples
+    uint16_t adc[300];
+    uint8_t hits[300];
+    size_t nextCheck = Capacity / 3;
+
+    while (ref.samples.size() < 4 * Capacity + 123) {
+        // Gaps of up to 40 ms between some blocks, now and then 65.5 ms to 2 s
+        if (rnd() % 8 == 0) t += (1 + rnd() % 400) * SAMPLE_US;
+        if (rnd() % 64 == 0) t += 65535 + rnd() % 2000000;
+
+        size_t n = 1 + rnd() % 300;
+        for (size_t i = 0; i < n; i++) {
+            hits[i] = rnd() % 150 == 0;
+            adc[i] = hits[i] ? (uint16_t)(2000 + rnd() % 2000) : (uint16_t)(100 + rnd() % 40);
+            uint32_t seq = (uint32_t)ref.samples.size();
+            ref.samples.push_back({t + (uint32_t)i * SAMPLE_US, adc[i], hits[i]});
+            if (hits[i]) ref.hitSeqs.push_back(seq);
+        }
+
+        if (rnd() % 16 == 0) {
+            for (size_t i = 0; i < n; i++) buf->record(adc[i], hits[i], t + (uint32_t)i * SAMPLE_US);
+        } else {
+            buf->recordBlock(adc, hits, n, t, SAMPLE_US);
+        }
+        t += (uint32_t)n * SAMPLE_US;
+
+        // Tiered: leave the flush behind now and then so reads span both tiers
+        if (rnd() % 4 != 0) buf->service();
+
+        if (ref.samples.size() >= nextCheck) {
+            checkContents(*buf, ref, fullRing);
+            nextCheck += Capacity / 3;
+        }
+    }
+    checkContents(*buf, ref, fullRing);
+
+    printf("  %-34s %6zu slots  %6zu samples  %4zu hits  %s\n", Storage::NAME, Capacity,
+           ref.samples.size(), ref.hitSeqs.size(), g_failures == before ? "ok" : "FAILED");
+    delete buf;
+}
+
+template <typename Storage>
+static void testLayoutCapacities(bool fullRing = true) {
+    testLayout<Storage, 4096>(fullRing);
+    testLayout<Storage, 5000>(fullRing);
+}
+
+/**
+ * @brief Tiered stalls: one per block the writer had to flush itself
+ */
+static void testTieredStalls() {
+    using Buffer = SampleBufferT<RATE_HZ, 1, TieredStorage, 16 * 1024>;
+    constexpr size_t BLOCK = TieredStorage::BLOCK;
+    Buffer* buf = new Buffer();
+    int before = g_failures;
+    CHECK(buf->begin(), "allocation failed");
+
+    std::vector<uint16_t> adc(BLOCK, 100);
+    std::vector<uint8_t> hits(BLOCK, 0);
+    uint32_t t = 0;
+    auto writeBlocks = [&](size_t blocks, bool service) {
+        for (size_t b = 0; b < blocks; b++) {
+            buf->recordBlock(adc.data(), hits.data(), BLOCK, t, SAMPLE_US);
+            t += BLOCK * SAMPLE_US;
+            if (service) buf->service();
+        }
+    };
+
+    // Without service() the hot ring fills; every block after that stalls
+    writeBlocks(TieredStorage::HOT_BLOCKS + 3, false);
+    CHECK(buf->storageStalls() == 3, "%u stalls with service() withheld, expected 3",
+          buf->storageStalls());
+
+    // service() keeps up with one block per call
+    for (int i = 0; i < 10; i++) buf->service();
+    writeBlocks(2 * TieredStorage::HOT_BLOCKS, true);
+    CHECK(buf->storageStalls() == 3, "%u stalls with service() running, expected 3",
+          buf->storageStalls());
+
+    printf("  tiered stalls counted  %s\n", g_failures == before ? "ok" : "FAILED");
+    delete buf;
+}
+
+/**
+ * @brief Off-nominal deltas beyond the correction table are counted, not lost silently
+ */
+template <typename Storage>
+static void testCorrectionsDropped() {
+    using Buffer = SampleBufferT<RATE_HZ, 1, Storage, 16 * 1024>;
+    constexpr size_t JITTERED = SparseDeltas::MAX_CORRECTIONS + 500;
+    Buffer* buf = new Buffer();
+    int before = g_failures;
+    CHECK(buf->begin(), "allocation failed");
+
+    // First sample on the grid, then every later one a microsecond late
+    uint16_t adc = 100;
+    uint8_t hit = 0;
+    uint32_t t = buf->lastSampleUs() + SAMPLE_US;
+    buf->recordBlock(&adc, &hit, 1, t, SAMPLE_US);
+    for (size_t i = 0; i < JITTERED; i++) {
+        t += SAMPLE_US + 1;
+        buf->recordBlock(&adc, &hit, 1, t, SAMPLE_US);
+    }
+    CHECK(buf->correctionsDropped() == JITTERED - SparseDeltas::MAX_CORRECTIONS,
+          "%u corrections dropped, expected %zu", buf->correctionsDropped(),
+          JITTERED - SparseDeltas::MAX_CORRECTIONS);
+    CHECK(buf->timeOf(JITTERED) == t, "newest sample at %u us, expected %u", buf->timeOf(JITTERED), t);
+
+    printf("  %-34s dropped corrections counted  %s\n", Storage::NAME,
+           g_failures == before ? "ok" : "FAILED");
+    delete buf;
+}
+
+/**
+ * @brief Pulse pedestals come from the pre-hit sample, not the re-arm sample
+ *
+ * Each pulse has a unique pre-hit sample and a re-arm sample that differs
+ * from it. Every other pulse starts on the sample right after the previous
+ * re-arm, so that re-arm sample is its pre-hit sample.
+ */
+static void testPulsePedestal() {
+    printf("pulse: pedestal is the sample before the hit\n");
+    int before = g_failures;
+    const SEEsThresholds th = {400, 3000, 400, 300, 0, 0};
+    const uint16_t shape[] = {1000, 2000, 1500, 800};
+
+    std::vector<uint16_t> stream;
+    std::vector<uint16_t> pedestals;
+    std::vector<uint32_t> integrals;
+    for (uint16_t k = 0; k < 40; k++) {
+        if (k % 2 == 0) {
+            for (int i = 0; i < 10; i++) stream.push_back(100);
+            stream.push_back(150 + k);
+        }
+        uint16_t pedestal = stream.back();
+        uint32_t integral = 0;
+        for (uint16_t v : shape) {
+            stream.push_back(v + k);
+            integral += v + k - pedestal;
+        }
+        stream.push_back(300 + k);  // re-arm
+        pedestals.push_back(pedestal);
+        integrals.push_back(integral);
+    }
+
+    SEEs_Detector detector;
+    SEEs_Pulse tracker;
+    std::vector<SEEsPulse> records;
+    uint32_t t = 0;
+    for (uint16_t adc : stream) {
+        switch (detector.step(adc, t, th)) {
+        case SEEs_Detector::Step::Armed:
+            tracker.idle(adc);
+            break;
+        case SEEs_Detector::Step::Hit:
+            tracker.start(t, adc);
+            break;
+        case SEEs_Detector::Step::Pulse:
+            tracker.add(t, adc);
+            break;
+        case SEEs_Detector::Step::Rearm: {
+            SEEsPulse rec;
+            tracker.finish(t, adc, 0, rec);
+            records.push_back(rec);
+            break;
+        }
+        }
+        t += SAMPLE_US;
+    }
+
+    CHECK(records.size() == pedestals.size(), "%zu pulses, expected %zu", records.size(), pedestals.size());
+    for (size_t i = 0; i < records.size() && i < pedestals.size(); i++) {
+        CHECK(records[i].pedestal_adc == pedestals[i], "pulse %zu: pedestal %u, expected %u",
+              i, records[i].pedestal_adc, pedestals[i]);
+        CHECK(records[i].integral == integrals[i], "pulse %zu: integral %u, expected %u",
+              i, records[i].integral, integrals[i]);
+    }
+    printf("  %zu pulses  %s\n", records.size(), g_failures == before ? "ok" : "FAILED");
+}
+
+int main() {
+    printf("buffer: time index, hit index and ring wrap per layout\n");
+    testLayoutCapacities<SoaStorage>();
+    testLayoutCapacities<AosStorage>();
+    testLayoutCapacities<Packed12Storage>();
+    testLayoutCapacities<CompressedStorage>(false);  // may evict before the ring wraps
+    testLayoutCapacities<TieredStorage>();
+    testTieredStalls();
+    testCorrectionsDropped<SoaStorage>();
+    testCorrectionsDropped<Packed12Storage>();
+    testPulsePedestal();
+
+    if (g_failures) printf("%d check(s) failed\n", g_failures);
+    return g_failures ? 1 : 0;
+}
@@ -7,12 +7,38 @@
  */
 
 #include "SEEs_ADC.hpp"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
 
 SEEs_ADC::SEEs_ADC(uint8_t adcPin, uint8_t ledPin)
     : _adcPin(adcPin), _ledPin(ledPin),
-      _armed(true), _ledState(false),
-      _t0_us(0), _next_sample_us(0), _lastBlink(0), _last_hit_us(0),
-      _totalHits(0), _countsPerVolt(0) {}
+      _detectConfig{(uint16_t)(LOWER_ENTER_V * 1000 + 0.5f), (uint16_t)(UPPER_LIMIT_V * 1000 + 0.5f),
+                    (uint16_t)(LOWER_EXIT_V * 1000 + 0.5f), REFRACT_US, 0, 0, 0,
+                    (uint16_t)(PILEUP_DIP_V * 1000 + 0.5f)},
+      _thresholds{ENTER_ADC, UPPER_ADC, EXIT_ADC, REFRACT_US, 0, 0},
+      _kernel(SEEs_FirKernel<SEES_FILTER_TAPS>::make(SEEsFilterShape::Off)),
+      _ledState(false),
+      _t0_us(0), _lastBlink(0), _pulseFrameSeq(0), _textPulses(false),
+      _layer(0), _acq(adcPin),
+      _streamMode(StreamMode::Text), _frameSeq(0), _batch(),
+      _snapState(SnapState::Idle), _snapEndMs(0),
+      _snapWindowed(false), _snapStartUs(0), _snapStopUs(0),
+      _evPre(EVENT_PRE_SAMPLES), _evPost(EVENT_POST_SAMPLES),
+      _evFrameSeq(0), _sumFrameSeq(0),
+      _coinc(COINC_WINDOW_US), _coincFrameSeq(0),
+      _hist(HIST_MIN_ADC, HIST_MAX_ADC, HIST_WINDOW_US), _histFrameSeq(0),
+      _slots(0), _lostSeen(0), _lostInSnap(0), _maxBacklog(0), _periodBacklog(0),
+      _statsFrameSeq(0) {
+    for (size_t ch = 0; ch < CHANNELS; ch++) {
+        _totalHits[ch] = 0;
+        _pileups[ch] = 0;
+        _deadUs[ch] = 0;
+        _pulse[ch].setPileupDip(PILEUP_ADC);
+    }
+    resetEvents(0);
+    _statsBase = _statsPeriod = statCounters();
+}
 
 void SEEs_ADC::begin() {
     pinMode(_ledPin, OUTPUT);
@@ -27,7 +53,11 @@ void SEEs_ADC::begin() {
 
     // Initialize RAM-based sample buffer
     Serial.println("[SEEs] Initializing sample buffer...");
-    if (!_sampleBuffer.begin()) {
+    bool allocated = true;
+    for (size_t ch = 0; ch < CHANNELS; ch++) {
+        allocated = _sampleBuffer[ch].begin() && allocated;
+    }
+    if (!allocated) {
         Serial.println("[SEEs] ERROR: Failed to allocate buffer!");
         Serial.println("[SEEs] System cannot continue - halting");
         while (1) {
@@ -37,20 +67,31 @@ void SEEs_ADC::begin() {
     }
 
     Serial.println("[SEEs] Body cam mode: ALWAYS streaming");
-    Serial.println("[SEEs] Commands: snap");
+    Serial.println("[SEEs] Commands: snap [pre_ms post_ms], snap hit <n> <pre_ms> <post_ms>,");
+    Serial.println("[SEEs]           hits, stream text|binary|events, events <pre> <post>,");
+    Serial.println("[SEEs]           hist [window_ms], set [enter|upper|exit <mV>] [refract <us>]");
+    Serial.println("[SEEs]           set baseline 1 [sigma <tenths>] for baseline-relative thresholds");
+    Serial.println("[SEEs]           set filter 0|1|2 shapes before detection (off, box, trapezoid)");
+    Serial.println("[SEEs]           set pileup <mV> splits pulses at a dip this deep (0 = off)");
+    Serial.println("[SEEs]           stats [reset] shows live/dead time and lost sample slots");
+    Serial.println("[SEEs]           pulses on|off prints a pulse line per hit in text mode");
+    if (CHANNELS > 1) {
+        Serial.print("[SEEs] Channels: ");
+        Serial.print((unsigned long)CHANNELS);
+        Serial.println(" layers; layer <n> selects the streamed/snapped layer");
+        Serial.println("[SEEs] coinc [window_us] shows coincidence depths / sets the window");
+    }
     Serial.println("[SEEs] Data format: time_ms,voltage_V,hit,total_hits");
 
-    // Configure ADC
-    analogReadResolution(ADC_BITS);
-    analogReadAveraging(ADC_AVG_HW);
-    (void)analogRead(_adcPin);  // Warm-up read
-
     // Initialize timing
-    _next_sample_us = micros();
     _lastBlink = millis();
     _t0_us = micros();
+    _hist.start(_t0_us);
 
-    _countsPerVolt = ADC_VREF / ((1UL << ADC_BITS) - 1UL);
+    // Configure ADC and start timer/DMA-driven sampling
+    if (!_acq.begin(SAMPLE_US, ADC_BITS, ADC_AVG_HW)) {
+        Serial.println("[SEEs] ERROR: Failed to start sample timer!");
+    }
 
     Serial.println("[SEEs] ====================================");
     Serial.println("[SEEs] Ready - buffer recording started");
@@ -67,8 +108,17 @@ void SEEs_ADC::update() {
     // Update LED state
     updateLED();
 
-    // ALWAYS sample into buffer (body cam mode)
+    // Advance any snap in progress (before recording, so the drain
+    // stays ahead of the samples about to overwrite the snapshot)
+    serviceSnap();
+
+    // ALWAYS drain samples into buffer (body cam mode)
     sampleAndStream();
+
+    // Background buffer maintenance (e.g. flushing to PSRAM)
+    for (size_t ch = 0; ch < CHANNELS; ch++) {
+        _sampleBuffer[ch].service();
+    }
 }
 
 void SEEs_ADC::processCommand(const String& cmd) {
@@ -76,19 +126,181 @@ void SEEs_ADC::processCommand(const String& cmd) {
     cmdLower.trim();
     cmdLower.toLowerCase();
 
-    if (cmdLower == "snap") {
-        Serial.println("[SEEs] SNAP command received");
-        Serial.println("[SEEs] Waiting 2.5s for post-trigger data...");
+    // Numeric arguments must parse to the end ("snap 200 50x" is not a snap)
+    unsigned long preMs = 0, postMs = 0, hitNumber = 0;
+    int used = 0;
+    bool windowed = sscanf(cmdLower.c_str(), "snap %lu %lu%n", &preMs, &postMs, &used) == 2 &&
+                    cmdLower.c_str()[used] == '\0';
+    bool aroundHit = sscanf(cmdLower.c_str(), "snap hit %lu %lu %lu%n",
+                            &hitNumber, &preMs, &postMs, &used) == 3 &&
+                     cmdLower.c_str()[used] == '\0';
+    unsigned long preSamples = 0, postSamples = 0, layer = 0, windowUs = 0, windowMs = 0;
+
+    if (aroundHit) {
+        if (_snapState != SnapState::Idle) {
+            Serial.println("[SEEs] Snap already in progress");
+            return;
+        }
+        if (!snapWindowFits(preMs, postMs)) return;
 
-        // Continue sampling for exactly 2.5s post-trigger
-        uint32_t endTime = millis() + 2500;
-        while (millis() < endTime) {
-            sampleAndStream();
+        uint32_t hitUs;
+        uint16_t adc;
+        if (!buffer().findHit(hitNumber, hitUs, adc)) {
+            Serial.print("[SEEs] Hit ");
+            Serial.print(hitNumber);
+            Serial.println(" is not in the buffer");
+            return;
         }
 
-        // Output all buffered samples
-        _sampleBuffer.outputSnap();
-        Serial.println("[SEEs] Snap complete");
+        // Wait only if the window reaches past the newest sample
+        _snapStartUs = hitUs - preMs * 1000UL;
+        _snapStopUs = hitUs + postMs * 1000UL;
+        int32_t aheadUs = (int32_t)(_snapStopUs - buffer().lastSampleUs());
+        _snapEndMs = millis() + (aheadUs > 0 ? (uint32_t)aheadUs / 1000 : 0);
+        _snapWindowed = true;
+        _snapState = SnapState::PostTrigger;
+        Serial.print("[SEEs] SNAP around hit ");
+        Serial.println(hitNumber);
+    }
+    else if (cmdLower == "hits") {
+        listHits();
+    }
+    else if (cmdLower == "stats") {
+        printStats();
+    }
+    else if (cmdLower == "stats reset") {
+        _statsBase = statCounters();
+        _maxBacklog = 0;
+        Serial.println("[SEEs] Stats reset");
+    }
+    else if (sscanf(cmdLower.c_str(), "layer %lu%n", &layer, &used) == 1 &&
+             cmdLower.c_str()[used] == '\0') {
+        if (layer >= CHANNELS) {
+            Serial.print("[SEEs] Layer must be 0..");
+            Serial.println((unsigned long)CHANNELS - 1);
+            return;
+        }
+        if (_snapState != SnapState::Idle) {
+            Serial.println("[SEEs] Snap in progress - layer unchanged");
+            return;
+        }
+        flushBatch();
+        resetEvents(micros());
+        _layer = (uint8_t)layer;
+        Serial.print("[SEEs] Layer: ");
+        Serial.println(_layer);
+    }
+    else if (cmdLower == "pulses on" || cmdLower == "pulses off") {
+        _textPulses = cmdLower == "pulses on";
+        Serial.print("[SEEs] Text pulse lines: ");
+        Serial.println(_textPulses ? "on" : "off");
+    }
+    else if (cmdLower == "coinc") {
+        printCoincidenceCounts();
+    }
+    else if (sscanf(cmdLower.c_str(), "coinc %lu%n", &windowUs, &used) == 1 &&
+             cmdLower.c_str()[used] == '\0') {
+        if (CHANNELS < 2) {
+            Serial.println("[SEEs] Coincidence needs SEES_CHANNELS > 1");
+            return;
+        }
+        if (windowUs > 0xFFFF) {
+            Serial.println("[SEEs] Coincidence window must be 0..65535 us");
+            return;
+        }
+        _coinc.setWindow(windowUs);
+        Serial.print("[SEEs] Coincidence window: ");
+        Serial.print(windowUs);
+        Serial.println(" us");
+    }
+    else if (cmdLower == "hist") {
+        const SEEsHistogram* hist = _hist.completed();
+        if (hist) {
+            SEEsHistogram rel = *hist;
+            rel.t_us -= _t0_us;
+            printHistogram(rel);
+        } else {
+            Serial.println("[SEEs] No histogram window completed yet");
+        }
+    }
+    else if (sscanf(cmdLower.c_str(), "hist %lu%n", &windowMs, &used) == 1 &&
+             cmdLower.c_str()[used] == '\0') {
+        if (windowMs < 100 || windowMs > 600000) {
+            Serial.println("[SEEs] Histogram window must be 100..600000 ms");
+            return;
+        }
+        _hist.setWindow(windowMs * 1000UL, micros());
+        Serial.print("[SEEs] Histogram window: ");
+        Serial.print(windowMs);
+        Serial.println(" ms");
+    }
+    else if (cmdLower == "set") {
+        printDetection();
+    }
+    else if (strncmp(cmdLower.c_str(), "set ", 4) == 0) {
+        setDetection(cmdLower.c_str() + 4);
+    }
+    else if (cmdLower == "snap" || windowed) {
+        if (_snapState != SnapState::Idle) {
+            Serial.println("[SEEs] Snap already in progress");
+            return;
+        }
+        if (windowed && !snapWindowFits(preMs, postMs)) return;
+
+        Serial.println("[SEEs] SNAP command received");
+        if (windowed) {
+            uint32_t now = micros();
+            _snapStartUs = now - preMs * 1000UL;
+            _snapStopUs = now + postMs * 1000UL;
+        } else {
+            postMs = SNAP_POST_MS;
+        }
+        Serial.print("[SEEs] Waiting ");
+        Serial.print(postMs);
+        Serial.println(" ms for post-trigger data...");
+
+        // Keep sampling post-trigger; serviceSnap() takes it from here
+        _snapWindowed = windowed;
+        _snapEndMs = millis() + postMs;
+        _snapState = SnapState::PostTrigger;
+    }
+    else if (cmdLower == "stream text") {
+        flushBatch();
+        _streamMode = StreamMode::Text;
+        Serial.println("[SEEs] Stream mode: text");
+    }
+    else if (cmdLower == "stream binary") {
+        _streamMode = StreamMode::Binary;
+        _batch.count = 0;
+        Serial.println("[SEEs] Stream mode: binary");
+    }
+    else if (cmdLower == "stream events") {
+        flushBatch();
+        resetEvents(micros());
+        _streamMode = StreamMode::Events;
+        Serial.print("[SEEs] Stream mode: events (");
+        Serial.print(_evPre);
+        Serial.print(" pre, ");
+        Serial.print(_evPost);
+        Serial.println(" post samples)");
+    }
+    else if (sscanf(cmdLower.c_str(), "events %lu %lu%n", &preSamples, &postSamples, &used) == 2 &&
+             cmdLower.c_str()[used] == '\0') {
+        if (preSamples >= SEES_EVENT_MAX_SAMPLES ||
+            postSamples >= SEES_EVENT_MAX_SAMPLES - preSamples) {
+            Serial.print("[SEEs] Event window too long (max ");
+            Serial.print((unsigned long)SEES_EVENT_MAX_SAMPLES - 1);
+            Serial.println(" samples pre + post)");
+            return;
+        }
+        _evPre = (uint16_t)preSamples;
+        _evPost = (uint16_t)postSamples;
+        resetEvents(micros());
+        Serial.print("[SEEs] Event window: ");
+        Serial.print(_evPre);
+        Serial.print(" pre, ");
+        Serial.print(_evPost);
+        Serial.println(" post samples");
     }
     else if (cmdLower.length() > 0) {
         Serial.print("[SEEs] Unknown command: ");
@@ -96,6 +308,98 @@ void SEEs_ADC::processCommand(const String& cmd) {
     }
 }
 
+bool SEEs_ADC::snapWindowFits(unsigned long preMs, unsigned long postMs) {
+    // Also keeps preMs/postMs * 1000 inside 32 bits (see BUFFER_MS)
+    if (preMs <= BUFFER_MS && postMs <= BUFFER_MS - preMs) return true;
+
+    Serial.print("[SEEs] Snap window longer than the buffer (");
+    Serial.print(BUFFER_MS);
+    Serial.println(" ms)");
+    return false;
+}
+
+void SEEs_ADC::listHits() {
+    uint32_t now = buffer().lastSampleUs();
+    Serial.print("[SEEs] ");
+    Serial.print((unsigned long)buffer().heldHits());
+    Serial.print(" hits in buffer, ");
+    Serial.print(buffer().countHits(now - 999999UL, now));
+    Serial.println(" in the last second");
+
+    // Rate correction inputs: piled-up particles and the time the layer was blind
+    uint32_t hits = _totalHits[_layer];
+    uint32_t elapsed = now - _t0_us;
+    Serial.print("[SEEs] Layer ");
+    Serial.print(_layer);
+    Serial.print(": ");
+    Serial.print(hits);
+    Serial.print(" hits + ");
+    Serial.print(_pileups[_layer]);
+    Serial.print(" piled-up (");
+    Serial.print(hits ? 100.0f * _pileups[_layer] / (hits + _pileups[_layer]) : 0.0f, 1);
+    Serial.print("%), dead ");
+    Serial.print(elapsed ? 100.0f * _deadUs[_layer] / elapsed : 0.0f, 2);
+    Serial.println("%");
+
+    uint32_t first = buffer().firstHit();
+    for (uint32_t n = first; n != first + buffer().heldHits(); n++) {
+        uint32_t t;
+        uint16_t adc;
+        if (!buffer().findHit(n, t, adc)) continue;
+        Serial.print("[SEEs] Hit ");
+        Serial.print(n);
+        Serial.print(" at ");
+        Serial.print((t - _t0_us) / 1000.0f, 3);
+        Serial.print(" ms, ");
+        Serial.print(adc * VOLTS_PER_COUNT, 4);
+        Serial.println(" V");
+    }
+}
+
+void SEEs_ADC::serviceSnap() {
+    switch (_snapState) {
+    case SnapState::Idle:
+        break;
+
+    case SnapState::PostTrigger: {
+        if ((int32_t)(millis() - _snapEndMs) < 0) break;
+
+        // A window waits until its last sample is recorded (or acquisition stalls)
+        if (_snapWindowed &&
+            (int32_t)(buffer().lastSampleUs() - _snapStopUs) < 0 &&
+            (int32_t)(millis() - _snapEndMs) < (int32_t)SNAP_SETTLE_MS) {
+            break;
+        }
+
+        // Don't interleave a partial batch with the CSV dump
+        flushBatch();
+
+        // Binary stream hosts get the snap as frames too
+        SnapFormat format = _streamMode == StreamMode::Text ? SnapFormat::Text
+                                                             : SnapFormat::Binary;
+        bool started = _snapWindowed
+            ? buffer().extract(_snapStartUs, _snapStopUs, format, _t0_us)
+            : buffer().beginSnap(format, _t0_us);
+        if (!started) {
+            _snapState = SnapState::Idle;
+            break;
+        }
+        _snapState = SnapState::Draining;
+    }
+        // fall through - start draining right away
+
+    case SnapState::Draining: {
+        // Output at least as many samples as are waiting to be recorded
+        size_t samples = SNAP_CHUNK_SAMPLES + 2 * _acq.pending();
+        if (buffer().outputSnapChunk(samples)) {
+            Serial.println("[SEEs] Snap complete");
+            _snapState = SnapState::Idle;
+        }
+        break;
+    }
+    }
+}
+
 void SEEs_ADC::updateLED() {
     // Always blink - body cam mode is always active
     uint32_t now = millis();
@@ -107,38 +411,636 @@ void SEEs_ADC::updateLED() {
 }
 
 void SEEs_ADC::sampleAndStream() {
-    // Timing check
-    uint32_t now_us = micros();
-    if ((int32_t)(now_us - _next_sample_us) < 0) return;
-    _next_sample_us += SAMPLE_US;
+    _acq.poll();
+    trackStats(_acq.pending());
+
+    // Process everything acquired since the last call
+    SampleBlock block;
+    while (_acq.nextBlock(block)) {
+        _slots += block.n;
 
-    // Read ADC
-    uint16_t raw = analogRead(_adcPin);
-    float v = raw * _countsPerVolt;
+        // Every layer runs its own detector over the block, on the common timebase
+        for (size_t ch = 0; ch < CHANNELS; ch++) {
+            uint32_t t_us = block.t0_us;
+            for (size_t i = 0; i < block.n; i++) {
+                _blockHits[ch][i] = processSample(ch, block.adc[ch][i], t_us);
+                t_us += block.dt_us;
+            }
 
-    // Windowed detection with hysteresis + refractory
+            // Record to RAM buffer (compact format) in one pass
+            _sampleBuffer[ch].recordBlock(block.adc[ch], _blockHits[ch], block.n,
+                                          block.t0_us, block.dt_us);
+        }
+
+        // All layers are processed up to the block's last sample
+        if (block.n > 0) {
+            uint32_t last_us = block.t0_us + (block.n - 1) * block.dt_us;
+            if (CHANNELS > 1) sendCoincidences(last_us);
+            if (_hist.roll(last_us)) sendHistogram();
+
+            // Records cover whole slots, so the period is exact on the sample grid
+            trackStats(0);
+            uint64_t slots = _slots - _statsPeriod.slots + (_lostSeen - _statsPeriod.lost);
+            if (slots * _acq.periodUs() >= STATS_US) sendStats(last_us);
+        }
+    }
+}
+
+uint8_t SEEs_ADC::processSample(size_t ch, uint16_t raw, uint32_t now_us) {
+    // Detection and pulse records see the shaped signal; buffer and stream stay raw
+    uint16_t shaped = _detectConfig.filter ? _filter[ch].push(raw, _kernel, ADC_MAX) : raw;
+
+    // Windowed detection with hysteresis + refractory, in ADC counts
     uint8_t hit = 0;
-    if (_armed) {
-        if (v >= LOWER_ENTER_V && v <= UPPER_LIMIT_V &&
-            (now_us - _last_hit_us) >= REFRACT_US) {
-            hit = 1;
-            ++_totalHits;
-            _last_hit_us = now_us;
-            _armed = false;  // Disarm until voltage drops
+    switch (_detector[ch].step(shaped, now_us, _thresholds)) {
+    case SEEs_Detector::Step::Armed:
+        _pulse[ch].idle(shaped);
+        break;
+    case SEEs_Detector::Step::Hit:
+        hit = 1;
+        ++_totalHits[ch];
+        _pulse[ch].start(now_us, shaped);
+        if (CHANNELS > 1) _coinc.addHit(ch, now_us);
+        break;
+    case SEEs_Detector::Step::Pulse:
+        _pulse[ch].add(now_us, shaped);
+        break;
+    case SEEs_Detector::Step::Rearm: {
+        // The pulse is complete
+        SEEsPulse pulse;
+        _pulse[ch].finish(now_us, shaped, ch, pulse);
+
+        // Relative thresholds: bin the height above the baseline, as the edges are
+        uint16_t height = pulse.peak_adc;
+        if (_thresholds.relative) {
+            uint16_t base = _detector[ch].baseline().value();
+            height = height > base ? height - base : 0;
         }
-    } else {
-        if (v < LOWER_EXIT_V) {
-            _armed = true;  // Re-arm
+        _hist.add(ch, height);
+
+        // Blind from the hit to the re-arm, or to the end of the refractory time
+        uint32_t dead = now_us - pulse.t_us;
+        if (dead < _thresholds.refract_us) dead = _thresholds.refract_us;
+        _pileups[ch] += pulse.peaks - 1;
+        _deadUs[ch] += dead;
+        if (ch == _layer) {
+            _sumPileups += pulse.peaks - 1;
+            _sumDeadUs += dead;
         }
+        sendPulse(pulse);
+        break;
+    }
     }
 
-    // Record to RAM buffer (compact format)
-    _sampleBuffer.record(raw, hit);
+    // Only the selected layer is streamed
+    if (ch != _layer) return hit;
 
     // Stream to Serial (body cam mode)
+    if (_streamMode == StreamMode::Events) {
+        streamEvent(now_us, raw, hit);
+        return hit;
+    }
+    if (_streamMode == StreamMode::Binary) {
+        // Binary frames are split out by the host, so they can run during a snap
+        streamBinary(now_us, raw, hit);
+        return hit;
+    }
+
+    // Text lines would mix into the snap CSV - recording continues regardless
+    if (_snapState == SnapState::Draining) return hit;
+
     float t_ms = (now_us - _t0_us) / 1000.0f;
     Serial.print(t_ms, 3); Serial.print(',');
-    Serial.print(v, 4);    Serial.print(',');
+    Serial.print(raw * VOLTS_PER_COUNT, 4); Serial.print(',');
     Serial.print(hit);     Serial.print(',');
-    Serial.println(_totalHits);
+    Serial.println(_totalHits[_layer]);
+    return hit;
+}
+
+void SEEs_ADC::streamBinary(uint32_t now_us, uint16_t raw, uint8_t hit) {
+    // A batch is evenly spaced from t0_us; a gap in the samples starts a new one
+    if (_batch.count > 0 && now_us - _t0_us != _batch.t0_us + _batch.count * SAMPLE_US) {
+        flushBatch();
+    }
+
+    if (_batch.count == 0) {
+        _batch.t0_us = now_us - _t0_us;
+        _batch.dt_us = SAMPLE_US;
+    }
+
+    _batch.samples[_batch.count++] = raw | (hit ? SEES_SAMPLE_HIT_BIT : 0);
+    _batch.total_hits = _totalHits[_layer];
+
+    if (_batch.count == SEES_STREAM_BATCH) {
+        flushBatch();
+    }
+}
+
+void SEEs_ADC::flushBatch() {
+    if (_batch.count == 0) return;
+
+    // Frames are always full size; unused slots are zero
+    for (size_t i = _batch.count; i < SEES_STREAM_BATCH; i++) {
+        _batch.samples[i] = 0;
+    }
+
+    size_t n = sees_frame_encode(SEES_FRAME_SAMPLES, _frameSeq++,
+                                 &_batch, sizeof(_batch),
+                                 _frameBuf, sizeof(_frameBuf));
+    Serial.write(_frameBuf, n);
+    _batch.count = 0;
+}
+
+void SEEs_ADC::resetEvents(uint32_t now_us) {
+    _evSeq = 0;
+    _evSentEnd = 0;
+    _evRunStart = 0;
+    _evNext_us = now_us;
+    _evOpen = false;
+    _evFirst = _evTrigger = _evEnd = 0;
+    _evT0_us = 0;
+    _evCount = 0;
+    _sumStart_us = now_us;
+    _sumSamples = 0;
+    _sumHits = 0;
+    _sumAdc = 0;
+    _sumAdcSq = 0;
+    _sumPileups = 0;
+    _sumDeadUs = 0;
+}
+
+void SEEs_ADC::streamEvent(uint32_t now_us, uint16_t raw, uint8_t hit) {
+    // Waveforms are evenly spaced from t0_us, so neither side of a hit may
+    // span a gap: an open event ends before it, and pre-trigger samples
+    // start after it
+    if (now_us != _evNext_us) {
+        if (_evOpen) {
+            _evEnd = _evSeq;
+            sendEvent();
+        }
+        _evRunStart = _evSeq;
+    }
+    _evNext_us = now_us + SAMPLE_US;
+
+    uint32_t seq = _evSeq++;
+    _evRing[seq & (SEES_EVENT_MAX_SAMPLES - 1)] = raw | (hit ? SEES_SAMPLE_HIT_BIT : 0);
+
+    _sumSamples++;
+    _sumHits += hit;
+    _sumAdc += raw;
+    _sumAdcSq += (uint32_t)raw * raw;
+
+    if (hit) {
+        if (!_evOpen) {
+            // Pre-trigger samples, never re-sending the previous event's or
+            // reaching back past a gap
+            uint32_t from = (int32_t)(_evRunStart - _evSentEnd) > 0 ? _evRunStart : _evSentEnd;
+            uint32_t pre = _evPre;
+            if (pre > seq - from) pre = seq - from;
+            _evOpen = true;
+            _evFirst = seq - pre;
+            _evTrigger = seq;
+            _evT0_us = now_us - pre * SAMPLE_US - _t0_us;
+        }
+        // Pile-up extends the tail, up to one ring of samples
+        _evEnd = seq + _evPost + 1;
+        if (_evEnd - _evFirst > SEES_EVENT_MAX_SAMPLES) _evEnd = _evFirst + SEES_EVENT_MAX_SAMPLES;
+    }
+
+    if (_evOpen && seq + 1 == _evEnd) sendEvent();
+
+    if ((int32_t)(now_us - _sumStart_us) >= (int32_t)SUMMARY_US) sendSummary(now_us);
+}
+
+void SEEs_ADC::sendEvent() {
+    SEEsEventHeader hdr;
+    hdr.event_id = _evCount++;
+    hdr.t0_us = _evT0_us;
+    hdr.dt_us = SAMPLE_US;
+    hdr.count = (uint16_t)(_evEnd - _evFirst);
+    hdr.trigger_index = (uint16_t)(_evTrigger - _evFirst);
+    hdr.hits = 0;
+    hdr.total_hits = _totalHits[_layer];
+
+    uint8_t payload[sizeof(SEEsEventHeader) + 2 * SEES_EVENT_MAX_SAMPLES];
+    uint8_t* p = payload + sizeof(hdr);
+    for (uint32_t s = _evFirst; s != _evEnd; s++) {
+        uint16_t v = _evRing[s & (SEES_EVENT_MAX_SAMPLES - 1)];
+        hdr.hits += (v & SEES_SAMPLE_HIT_BIT) ? 1 : 0;
+        *p++ = v & 0xFF;
+        *p++ = v >> 8;
+    }
+    memcpy(payload, &hdr, sizeof(hdr));
+
+    size_t len = sizeof(hdr) + 2 * (size_t)hdr.count;
+    size_t n = sees_frame_encode(SEES_FRAME_EVENT, _evFrameSeq++, payload, (uint16_t)len,
+                                 _evFrameBuf, sizeof(_evFrameBuf));
+    Serial.write(_evFrameBuf, n);
+
+    _evOpen = false;
+    _evSentEnd = _evEnd;
+}
+
+void SEEs_ADC::sendSummary(uint32_t now_us) {
+    SEEsSummary sum;
+    sum.t_us = now_us - _t0_us;
+    sum.period_us = now_us - _sumStart_us;
+    sum.samples = _sumSamples;
+    sum.hits = _sumHits;
+    sum.total_hits = _totalHits[_layer];
+    sum.events = _evCount;
+    sum.baseline_adc = 0.0f;
+    sum.noise_adc = 0.0f;
+    if (_sumSamples > 0) {
+        float mean = (float)_sumAdc / _sumSamples;
+        float var = (float)_sumAdcSq / _sumSamples - mean * mean;
+        sum.baseline_adc = mean;
+        sum.noise_adc = var > 0.0f ? sqrtf(var) : 0.0f;
+    }
+    sum.pileups = _sumPileups;
+    sum.dead_us = _sumDeadUs;
+
+    size_t n = sees_frame_encode(SEES_FRAME_SUMMARY, _sumFrameSeq++, &sum, sizeof(sum),
+                                 _frameBuf, sizeof(_frameBuf));
+    Serial.write(_frameBuf, n);
+
+    _sumStart_us = now_us;
+    _sumSamples = 0;
+    _sumHits = 0;
+    _sumAdc = 0;
+    _sumAdcSq = 0;
+    _sumPileups = 0;
+    _sumDeadUs = 0;
+}
+
+void SEEs_ADC::sendCoincidences(uint32_t horizon_us) {
+    SEEsCoincidence rec;
+    while (_coinc.next(horizon_us, rec)) {
+        rec.t_us -= _t0_us;
+
+        if (_streamMode != StreamMode::Text) {
+            size_t n = sees_frame_encode(SEES_FRAME_COINCIDENCE, _coincFrameSeq++, &rec, sizeof(rec),
+                                         _frameBuf, sizeof(_frameBuf));
+            Serial.write(_frameBuf, n);
+            continue;
+        }
+
+        // Still counted while a text snap drains, just not printed
+        if (_snapState == SnapState::Draining) continue;
+        // Single-layer events are the bulk of the rate; "coinc" tallies them
+        if (__builtin_popcount(rec.layer_mask) < 2) continue;
+
+        Serial.print("[SEEs] Coincidence at ");
+        Serial.print(rec.t_us / 1000.0f, 3);
+        Serial.print(" ms: depth ");
+        Serial.print(rec.depth);
+        Serial.print(", layers ");
+        bool first = true;
+        for (size_t ch = 0; ch < CHANNELS; ch++) {
+            if (!((rec.layer_mask >> ch) & 1)) continue;
+            if (!first) Serial.print('+');
+            Serial.print((unsigned long)ch);
+            first = false;
+        }
+        Serial.print(", spread ");
+        Serial.print(rec.spread_us);
+        Serial.println(" us");
+    }
+}
+
+void SEEs_ADC::printCoincidenceCounts() {
+    if (CHANNELS < 2) {
+        Serial.println("[SEEs] Coincidence needs SEES_CHANNELS > 1");
+        return;
+    }
+
+    Serial.print("[SEEs] Coincidences (window ");
+    Serial.print(_coinc.windowUs());
+    Serial.println(" us):");
+    for (size_t depth = 0; depth <= CHANNELS; depth++) {
+        Serial.print("[SEEs]   depth ");
+        Serial.print((unsigned long)depth);
+        Serial.print(": ");
+        Serial.println(_coinc.count(depth));
+    }
+    if (_coinc.dropped() > 0) {
+        Serial.print("[SEEs]   dropped hits: ");
+        Serial.println(_coinc.dropped());
+    }
+}
+
+void SEEs_ADC::setDetection(const char* args) {
+    // All pairs are validated together and applied as one change
+    SEEsDetectConfig cfg = _detectConfig;
+    char key[12];
+    unsigned long value;
+    int used = 0;
+    while (sscanf(args, " %11s %lu%n", key, &value, &used) == 2) {
+        args += used;
+        if (strcmp(key, "enter") == 0 && value <= 0xFFFF) cfg.enter_mv = value;
+        else if (strcmp(key, "upper") == 0 && value <= 0xFFFF) cfg.upper_mv = value;
+        else if (strcmp(key, "exit") == 0 && value <= 0xFFFF) cfg.exit_mv = value;
+        else if (strcmp(key, "refract") == 0 && value <= MAX_REFRACT_US) cfg.refract_us = value;
+        else if (strcmp(key, "baseline") == 0 && value <= 1) cfg.baseline = value;
+        else if (strcmp(key, "sigma") == 0 && value <= MAX_SIGMA_TENTHS) cfg.sigma_tenths = value;
+        else if (strcmp(key, "filter") == 0 && value <= (unsigned long)SEEsFilterShape::Trapezoid)
+            cfg.filter = value;
+        else if (strcmp(key, "pileup") == 0 && value <= 0xFFFF) cfg.pileup_mv = value;
+        else {
+            Serial.print("[SEEs] Bad setting or value: ");
+            Serial.println(key);
+            return;
+        }
+    }
+    if (sscanf(args, " %11s", key) == 1) {
+        Serial.println("[SEEs] Usage: set [enter|upper|exit <mV>] [refract <us>] "
+                       "[baseline 0|1] [sigma <tenths>] [filter 0|1|2] [pileup <mV>] ...");
+        return;
+    }
+
+    uint32_t vrefMv = (uint32_t)(ADC_VREF * 1000 + 0.5f);
+    if (cfg.exit_mv == 0 || cfg.exit_mv > cfg.enter_mv || cfg.enter_mv > cfg.upper_mv ||
+        cfg.upper_mv > vrefMv || cfg.pileup_mv > vrefMv) {
+        Serial.print("[SEEs] Need 0 < exit <= enter <= upper <= ");
+        Serial.print((unsigned long)vrefMv);
+        Serial.print(" mV, pileup <= ");
+        Serial.print((unsigned long)vrefMv);
+        Serial.println(" mV - unchanged");
+        return;
+    }
+
+    // Counts are worked out here, once; the per-sample compare is unchanged.
+    // Commands run between blocks, so no sample sees a partial update.
+    SEEsThresholds th;
+    th.enter_adc = sees_counts_at_least(cfg.enter_mv / 1000.0f, VOLTS_PER_COUNT, ADC_MAX);
+    th.upper_adc = sees_counts_above(cfg.upper_mv / 1000.0f, VOLTS_PER_COUNT, ADC_MAX) - 1;
+    th.exit_adc = sees_counts_at_least(cfg.exit_mv / 1000.0f, VOLTS_PER_COUNT, ADC_MAX);
+    th.refract_us = cfg.refract_us;
+    th.relative = cfg.baseline;
+    th.sigma_tenths = cfg.sigma_tenths;
+    uint16_t dip = cfg.pileup_mv ? sees_counts_at_least(cfg.pileup_mv / 1000.0f, VOLTS_PER_COUNT, ADC_MAX) : 0;
+
+    // Tracking restarts from the next armed sample when it is switched on;
+    // a new kernel starts from a flat delay line at the next sample
+    bool reshape = cfg.filter != _detectConfig.filter;
+    if (reshape) _kernel = SEEs_FirKernel<SEES_FILTER_TAPS>::make((SEEsFilterShape)cfg.filter);
+    for (size_t ch = 0; ch < CHANNELS; ch++) {
+        if (cfg.baseline && !_detectConfig.baseline) _detector[ch].resetBaseline();
+        else _detector[ch].retune();
+        if (reshape) _filter[ch].reset();
+        _pulse[ch].setPileupDip(dip);
+    }
+    // Bin edges follow the window; switching to or from baseline-relative
+    // heights restarts the histogram window like a change of edges
+    if (cfg.baseline != _detectConfig.baseline) _hist.setWindow(_hist.windowUs(), micros());
+    _hist.setRange(th.enter_adc, th.upper_adc, micros());
+    _detectConfig = cfg;
+    _thresholds = th;
+    printDetection();
+}
+
+void SEEs_ADC::printDetection() {
+    Serial.print("[SEEs] Detection: enter ");
+    Serial.print(_detectConfig.enter_mv);
+    Serial.print(" mV (");
+    Serial.print(_thresholds.enter_adc);
+    Serial.print("), upper ");
+    Serial.print(_detectConfig.upper_mv);
+    Serial.print(" mV (");
+    Serial.print(_thresholds.upper_adc);
+    Serial.print("), exit ");
+    Serial.print(_detectConfig.exit_mv);
+    Serial.print(" mV (");
+    Serial.print(_thresholds.exit_adc);
+    Serial.print("), refract ");
+    Serial.print((unsigned long)_thresholds.refract_us);
+    Serial.print(" us, pileup ");
+    Serial.print(_detectConfig.pileup_mv);
+    Serial.println(" mV");
+
+    if (_detectConfig.filter) {
+        Serial.print("[SEEs] Shaping: ");
+        Serial.print((SEEsFilterShape)_detectConfig.filter == SEEsFilterShape::Box ? "box" : "trapezoid");
+        Serial.print(", ");
+        Serial.print((unsigned long)SEES_FILTER_TAPS);
+        Serial.print(" taps (hits ~");
+        Serial.print((unsigned long)((SEES_FILTER_TAPS - 1) * SAMPLE_US / 2));
+        Serial.println(" us late)");
+    }
+
+    if (!_detectConfig.baseline) return;
+    const SEEs_Baseline& b = _detector[_layer].baseline();
+    Serial.print("[SEEs] Relative to baseline");
+    if (_detectConfig.sigma_tenths) {
+        Serial.print(", enter/exit >= ");
+        Serial.print(_detectConfig.sigma_tenths / 10.0f, 1);
+        Serial.print(" sigma");
+    }
+    Serial.print("; layer ");
+    Serial.print(_layer);
+    Serial.print(" baseline ");
+    Serial.print(b.value16() / 16.0f, 1);
+    Serial.print(" counts, noise ");
+    Serial.print(b.noise16() / 16.0f, 1);
+    Serial.println(" counts");
+}
+
+void SEEs_ADC::sendPulse(SEEsPulse& pulse) {
+    pulse.t_us -= _t0_us;
+
+    if (_streamMode != StreamMode::Text) {
+        size_t n = sees_frame_encode(SEES_FRAME_PULSE, _pulseFrameSeq++, &pulse, sizeof(pulse),
+                                     _frameBuf, sizeof(_frameBuf));
+        Serial.write(_frameBuf, n);
+        return;
+    }
+
+    // One line per hit costs serial bandwidth the CSV stream needs, so text
+    // mode prints them only on request; lines would also mix into a snap CSV
+    if (!_textPulses || _snapState == SnapState::Draining) return;
+
+    Serial.print("[SEEs] Pulse layer ");
+    Serial.print(pulse.layer);
+    Serial.print(" at ");
+    Serial.print(pulse.t_us / 1000.0f, 3);
+    Serial.print(" ms: peak ");
+    Serial.print(pulse.peak_adc);
+    Serial.print(", pedestal ");
+    Serial.print(pulse.pedestal_adc);
+    Serial.print(", integral ");
+    Serial.print((unsigned long)pulse.integral);
+    Serial.print(", rise ");
+    Serial.print(pulse.rise_us);
+    Serial.print(" us, duration ");
+    Serial.print(pulse.duration_us);
+    Serial.print(" us, peaks ");
+    Serial.println(pulse.peaks);
+}
+
+void SEEs_ADC::sendHistogram() {
+    SEEsHistogram hist = *_hist.completed();
+    hist.t_us -= _t0_us;
+
+    if (_streamMode != StreamMode::Text) {
+        size_t n = sees_frame_encode(SEES_FRAME_HISTOGRAM, _histFrameSeq++, &hist, sizeof(hist),
+                                     _frameBuf, sizeof(_frameBuf));
+        Serial.write(_frameBuf, n);
+        return;
+    }
+
+    // Kept for the "hist" command while a text snap drains
+    if (_snapState == SnapState::Draining) return;
+    printHistogram(hist);
+}
+
+void SEEs_ADC::trackStats(uint32_t backlog) {
+    uint16_t b = backlog > 0xFFFF ? 0xFFFF : (uint16_t)backlog;
+    if (b > _maxBacklog) _maxBacklog = b;
+    if (b > _periodBacklog) _periodBacklog = b;
+
+    // Overruns are charged to a snap if one was running when they were noticed
+    uint32_t lost = _acq.overflows();
+    if (lost != _lostSeen) {
+        if (_snapState != SnapState::Idle) _lostInSnap += lost - _lostSeen;
+        _lostSeen = lost;
+    }
+}
+
+SEEs_ADC::StatCounters SEEs_ADC::statCounters() const {
+    StatCounters c;
+    c.slots = _slots;
+    c.lost = _lostSeen;
+    c.lostInSnap = _lostInSnap;
+    c.overruns = _acq.overruns();
+    c.stalls = 0;
+    c.dtDropped = 0;
+    for (size_t ch = 0; ch < CHANNELS; ch++) {
+        c.stalls += _sampleBuffer[ch].storageStalls();
+        c.dtDropped += _sampleBuffer[ch].correctionsDropped();
+        c.hits[ch] = _totalHits[ch];
+        c.deadUs[ch] = _deadUs[ch];
+    }
+    return c;
+}
+
+void SEEs_ADC::sendStats(uint32_t now_us) {
+    static_assert(SEES_FRAME_OVERHEAD + sizeof(SEEsStats) <= sizeof(_frameBuf), "_frameBuf too small");
+
+    StatCounters now = statCounters();
+    const StatCounters& was = _statsPeriod;
+    SEEsStats rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.t_us = now_us - _t0_us;
+    rec.slots = (uint32_t)(now.slots - was.slots);
+    rec.lost_slots = now.lost - was.lost;
+    rec.period_us = (rec.slots + rec.lost_slots) * _acq.periodUs();
+    rec.lost_in_snap = now.lostInSnap - was.lostInSnap;
+    rec.overruns = now.overruns - was.overruns;
+    rec.max_backlog = _periodBacklog;
+    rec.layers = CHANNELS;
+    rec.dt_dropped = now.dtDropped - was.dtDropped;
+    for (size_t ch = 0; ch < CHANNELS; ch++) {
+        rec.hits[ch] = now.hits[ch] - was.hits[ch];
+        rec.dead_us[ch] = (uint32_t)(now.deadUs[ch] - was.deadUs[ch]);
+    }
+    _statsPeriod = now;
+    _periodBacklog = 0;
+
+    if (_streamMode != StreamMode::Text) {
+        size_t n = sees_frame_encode(SEES_FRAME_STATS, _statsFrameSeq++, &rec, sizeof(rec),
+                                     _frameBuf, sizeof(_frameBuf));
+        Serial.write(_frameBuf, n);
+        return;
+    }
+
+    if (_snapState == SnapState::Draining) return;
+    for (size_t ch = 0; ch < CHANNELS; ch++) {
+        uint64_t blind = (uint64_t)rec.dead_us[ch] + (uint64_t)rec.lost_slots * _acq.periodUs();
+        Serial.print("[SEEs] Stats at ");
+        Serial.print(rec.t_us / 1000.0f, 3);
+        Serial.print(" ms (");
+        Serial.print(rec.period_us / 1000);
+        Serial.print(" ms), layer ");
+        Serial.print((unsigned long)ch);
+        Serial.print(": slots ");
+        Serial.print(rec.slots);
+        Serial.print(", lost ");
+        Serial.print(rec.lost_slots);
+        Serial.print(" (");
+        Serial.print(rec.lost_in_snap);
+        Serial.print(" in snaps), overruns ");
+        Serial.print(rec.overruns);
+        Serial.print(", backlog ");
+        Serial.print(rec.max_backlog);
+        Serial.print(", dt dropped ");
+        Serial.print(rec.dt_dropped);
+        Serial.print(", hits ");
+        Serial.print(rec.hits[ch]);
+        Serial.print(", dead ");
+        Serial.print(rec.dead_us[ch]);
+        Serial.print(" us, live ");
+        Serial.print(rec.period_us ? 100.0f - 100.0f * blind / rec.period_us : 0.0f, 3);
+        Serial.println("%");
+    }
+}
+
+void SEEs_ADC::printStats() {
+    // Totals can outgrow 32 bits, so this works in 64-bit and seconds
+    trackStats(0);
+    StatCounters now = statCounters();
+    const StatCounters& was = _statsBase;
+    uint64_t slots = now.slots - was.slots;
+    uint32_t lost = now.lost - was.lost;
+    uint64_t periodUs = _acq.periodUs();
+    uint64_t elapsedUs = (slots + lost) * periodUs;
+
+    Serial.print("[SEEs] Stats over ");
+    Serial.print(elapsedUs / 1e6f, 3);
+    Serial.print(" s: ");
+    Serial.print((unsigned long)slots);
+    Serial.print(" slots, lost ");
+    Serial.print(lost);
+    Serial.print(" (");
+    Serial.print(now.lostInSnap - was.lostInSnap);
+    Serial.print(" in snaps), overruns ");
+    Serial.print(now.overruns - was.overruns);
+    Serial.print(", backlog max ");
+    Serial.print(_maxBacklog);
+    Serial.print(", storage stalls ");
+    Serial.print(now.stalls - was.stalls);
+    Serial.print(", time corrections dropped ");
+    Serial.println(now.dtDropped - was.dtDropped);
+
+    for (size_t ch = 0; ch < CHANNELS; ch++) {
+        uint64_t deadUs = now.deadUs[ch] - was.deadUs[ch];
+        uint64_t lostUs = lost * periodUs;
+        Serial.print("[SEEs]   layer ");
+        Serial.print((unsigned long)ch);
+        Serial.print(": ");
+        Serial.print(now.hits[ch] - was.hits[ch]);
+        Serial.print(" hits, dead ");
+        Serial.print(deadUs / 1e6f, 3);
+        Serial.print(" s detector + ");
+        Serial.print(lostUs / 1e6f, 3);
+        Serial.print(" s lost slots, live ");
+        Serial.print(elapsedUs ? 100.0f - 100.0f * (deadUs + lostUs) / elapsedUs : 0.0f, 3);
+        Serial.println("%");
+    }
+}
+
+void SEEs_ADC::printHistogram(const SEEsHistogram& hist) {
+    for (size_t ch = 0; ch < CHANNELS; ch++) {
+        Serial.print("[SEEs] Histogram at ");
+        Serial.print(hist.t_us / 1000.0f, 3);
+        Serial.print(" ms (");
+        Serial.print(hist.window_us / 1000);
+        Serial.print(" ms), layer ");
+        Serial.print((unsigned long)ch);
+        Serial.print(':');
+        for (size_t bin = 0; bin < SEES_HIST_BINS; bin++) {
+            Serial.print(' ');
+            Serial.print(hist.counts[ch][bin]);
+        }
+        Serial.println();
+    }
 }
@@ -4,6 +4,8 @@
  *
  * Provides snap command interface for SiPM data collection.
  * Body cam mode - always recording to RAM buffer.
+ * Sampling runs from a hardware timer or DMA (SEEs_Acquisition);
+ * update() drains and processes the acquired sample blocks.
  */
 
 #ifndef SEES_ADC_HPP
@@ -11,6 +13,13 @@
 
 #include <Arduino.h>
 #include "SampleBuffer.hpp"
+#include "SEEs_Acquisition.hpp"
+#include "SEEs_Coincidence.hpp"
+#include "SEEs_Histogram.hpp"
+#include "SEEs_Pulse.hpp"
+#include "SEEs_Detect.hpp"
+#include "SEEs_Filter.hpp"
+#include "SEEs_Interface.hpp"
 
 class SEEs_ADC {
 public:
@@ -33,46 +42,218 @@ public:
 
     /**
      * @brief Process a command from serial input
-     * @param cmd Command string ("snap")
+     * @param cmd Command string ("snap [pre_ms post_ms]", "snap hit <n> <pre_ms> <post_ms>",
+     *            "hits", "stream text|binary|events", "events <pre> <post>", "layer <n>",
+     *            "coinc [window_us]", "hist [window_ms]", "stats [reset]",
+     *            "set [enter|upper|exit <mV>] [refract <us>] [baseline 0|1] [sigma <tenths>]
+     *            [filter 0|1|2] [pileup <mV>] ...")
      */
     void processCommand(const String& cmd);
 
+    /**
+     * @brief Live stream encoding
+     *
+     * Text:   one CSV line per sample (time_ms,voltage_V,hit,total_hits)
+     * Binary: SEES_FRAME_SAMPLES frames of SEES_STREAM_BATCH raw samples
+     * Events: zero-suppressed - SEES_FRAME_EVENT waveforms around hits
+     *         plus a SEES_FRAME_SUMMARY per SUMMARY_US
+     */
+    enum class StreamMode : uint8_t { Text, Binary, Events };
+
 private:
     // Pin configuration
     uint8_t _adcPin;
     uint8_t _ledPin;
 
     // Configuration constants
-    static constexpr uint32_t SAMPLE_US = 100;       // 10 kS/s
+    static constexpr uint32_t SAMPLE_US = SampleBuffer::NOMINAL_DELTA_US;  // SEES_SAMPLE_RATE_HZ
     static constexpr uint32_t BLINK_MS = 500;
+    static constexpr uint32_t SNAP_SETTLE_MS = 100;  // max wait for the window's last samples
+    static constexpr uint64_t BUFFER_MS_64 =
+        (uint64_t)SampleBuffer::TOTAL_SAMPLES * 1000 / SampleBuffer::SAMPLES_PER_SEC;
+    static_assert(BUFFER_MS_64 <= UINT32_MAX / 1000, "snap windows are computed in 32-bit microseconds");
+    static constexpr uint32_t BUFFER_MS = (uint32_t)BUFFER_MS_64;
+    // Plain "snap" post-trigger recording: 2.5 s, or a quarter of a shorter
+    // window (e.g. 4 layers), so the snap always keeps pre-trigger data
+    static constexpr uint32_t SNAP_POST_MS = BUFFER_MS / 4 < 2500 ? BUFFER_MS / 4 : 2500;
+    static_assert(BUFFER_MS > SNAP_POST_MS, "plain snap would hold no pre-trigger data");
+    static constexpr size_t SNAP_CHUNK_SAMPLES = 64; // min snap samples per update()
     static constexpr int ADC_BITS = 12;
     static constexpr int ADC_AVG_HW = 1;
     static constexpr float ADC_VREF = 3.3f;
+    static constexpr uint16_t ADC_MAX = (1UL << ADC_BITS) - 1UL;
+    static constexpr float VOLTS_PER_COUNT = ADC_VREF / ADC_MAX;  // text output only
 
-    // Detection window (volts)
+    // Default detection window (volts) - changed at run time with "set"
     static constexpr float LOWER_ENTER_V = 0.30f;
     static constexpr float LOWER_EXIT_V = 0.300f;
     static constexpr float UPPER_LIMIT_V = 0.800f;
     static constexpr uint32_t REFRACT_US = 300;
+    static constexpr uint32_t MAX_REFRACT_US = 1000000;
+    static constexpr uint16_t MAX_SIGMA_TENTHS = 1000;
+    static constexpr float PILEUP_DIP_V = 0.050f;  // well above the ~5 mV noise
+
+    // The same window in raw counts - detection never converts to volts
+    static constexpr uint16_t ENTER_ADC = sees_counts_at_least(LOWER_ENTER_V, VOLTS_PER_COUNT, ADC_MAX);
+    static constexpr uint16_t UPPER_ADC = sees_counts_above(UPPER_LIMIT_V, VOLTS_PER_COUNT, ADC_MAX) - 1;
+    static constexpr uint16_t EXIT_ADC = sees_counts_at_least(LOWER_EXIT_V, VOLTS_PER_COUNT, ADC_MAX);
+    static constexpr uint16_t PILEUP_ADC = sees_counts_at_least(PILEUP_DIP_V, VOLTS_PER_COUNT, ADC_MAX);
+
+    // Event streaming defaults (samples around the triggering hit)
+    static constexpr uint16_t EVENT_PRE_SAMPLES = 32;
+    static constexpr uint16_t EVENT_POST_SAMPLES = 96;
+    static constexpr uint32_t SUMMARY_US = 1000000;
+
+    // Layer coincidence window: hits land on the sample grid, so one period
+    // is the tightest window that still pairs hits from the same particle
+    static constexpr uint32_t COINC_WINDOW_US = SAMPLE_US;
+
+    // Pulse peak histogram: 8 bins across the detection window (the last
+    // bin also counts peaks above it). These are the power-up edges; "set"
+    // moves them to the enter..upper counts in use
+    static constexpr uint32_t HIST_WINDOW_US = 5000000;
+    static constexpr uint16_t HIST_MIN_ADC = ENTER_ADC;
+    static constexpr uint16_t HIST_MAX_ADC = UPPER_ADC;
+
+    // Dead/live time record period (sample time)
+    static constexpr uint32_t STATS_US = 10000000;
+
+    static constexpr size_t CHANNELS = SEEs_Acquisition::CHANNELS;
+    static_assert(CHANNELS <= SEES_STATS_LAYERS && CHANNELS <= SEES_HIST_LAYERS,
+                  "records carry at most 4 layers");
+    static_assert(SampleBuffer::RAM_BYTES * CHANNELS <= SEES_RAM_BUDGET_BYTES,
+                  "per-channel sample buffers exceed the internal RAM budget - "
+                  "shorten SEES_WINDOW_SECONDS");
+    static_assert((SampleBuffer::BUFFER_SIZE_BYTES - SampleBuffer::RAM_BYTES) * CHANNELS <=
+                      SEES_PSRAM_BUDGET_BYTES,
+                  "per-channel sample buffers exceed the PSRAM budget");
 
-    // State variables
-    bool _armed;
+    // State variables (detector state per layer)
+    SEEs_Detector _detector[CHANNELS];
+    SEEsDetectConfig _detectConfig;  // as set; _thresholds is what detection uses
+    SEEsThresholds _thresholds;
+    SEEs_FirKernel<SEES_FILTER_TAPS> _kernel;
+    SEEs_FirFilter<SEES_FILTER_TAPS> _filter[CHANNELS];  // shaping ahead of _detector
     bool _ledState;
 
     uint32_t _t0_us;
-    uint32_t _next_sample_us;
     uint32_t _lastBlink;
-    uint32_t _last_hit_us;
-    uint32_t _totalHits;
+    uint32_t _totalHits[CHANNELS];
+    SEEs_Pulse _pulse[CHANNELS];     // pulse being tracked while disarmed
+    uint32_t _pileups[CHANNELS];     // extra peaks found inside pulses
+    uint64_t _deadUs[CHANNELS];      // disarmed or refractory time
+    uint16_t _pulseFrameSeq;
+    bool _textPulses;                // "pulses on": pulse lines in text mode (one per hit)
+
+    // Layer the live stream, snaps and hit queries use
+    uint8_t _layer;
+
+    // Timer/DMA-driven ADC sampling (blocks drained by update())
+    SEEs_Acquisition _acq;
+
+    // RAM-based sample buffer per layer (no SD required)
+    SampleBuffer _sampleBuffer[CHANNELS];
+    uint8_t _blockHits[CHANNELS][SEEs_Acquisition::BLOCK_SAMPLES];
+
+    // Binary streaming state
+    StreamMode _streamMode;
+    uint16_t _frameSeq;
+    SEEsSampleBatch _batch;
+    // Sized for the largest fixed frame sent from it (batch, summary, histogram, stats)
+    uint8_t _frameBuf[SEES_FRAME_OVERHEAD +
+                      (sizeof(SEEsHistogram) > sizeof(SEEsSampleBatch) ? sizeof(SEEsHistogram)
+                                                                       : sizeof(SEEsSampleBatch))];
+
+    // Snap runs as a state machine from update() - acquisition never stops
+    enum class SnapState : uint8_t { Idle, PostTrigger, Draining };
+    SnapState _snapState;
+    uint32_t _snapEndMs;
+    bool _snapWindowed;        // snap <pre_ms> <post_ms> / snap hit
+    uint32_t _snapStartUs;     // window, micros()
+    uint32_t _snapStopUs;
+
+    // Event streaming state: the last SEES_EVENT_MAX_SAMPLES samples stay in
+    // _evRing, so an open event is sent straight from it once complete
+    uint16_t _evPre;
+    uint16_t _evPost;
+    uint16_t _evRing[SEES_EVENT_MAX_SAMPLES];
+    uint32_t _evSeq;           // samples pushed since the mode was entered
+    uint32_t _evSentEnd;       // end of the last event (pre never reaches back past it)
+    uint32_t _evRunStart;      // first sample after the last gap (nor past this)
+    uint32_t _evNext_us;       // expected time of the next sample; any other starts a run
+    bool _evOpen;
+    uint32_t _evFirst;         // open event: first sample, trigger, end (exclusive)
+    uint32_t _evTrigger;
+    uint32_t _evEnd;
+    uint32_t _evT0_us;
+    uint32_t _evCount;         // events sent
+    uint16_t _evFrameSeq;
+    uint8_t _evFrameBuf[SEES_FRAME_OVERHEAD + sizeof(SEEsEventHeader) + 2 * SEES_EVENT_MAX_SAMPLES];
+
+    // Summary accumulators for the current period
+    uint32_t _sumStart_us;
+    uint32_t _sumSamples;
+    uint32_t _sumHits;
+    uint64_t _sumAdc;
+    uint64_t _sumAdcSq;
+    uint32_t _sumPileups;
+    uint32_t _sumDeadUs;
+    uint16_t _sumFrameSeq;
+
+    // Layer coincidence (CHANNELS > 1)
+    SEEs_Coincidence _coinc;
+    uint16_t _coincFrameSeq;
 
-    float _countsPerVolt;
+    // Pulse peak histogram, sent once per window
+    SEEs_Histogram _hist;
+    uint16_t _histFrameSeq;
 
-    // RAM-based sample buffer (no SD required)
-    SampleBuffer _sampleBuffer;
+    // Dead/live time: cumulative counters; "stats" and the SEEsStats records
+    // report the difference to a snapshot (taken by "stats reset" / per period)
+    struct StatCounters {
+        uint64_t slots;          // processed
+        uint32_t lost;           // acquisition overruns
+        uint32_t lostInSnap;
+        uint32_t overruns;
+        uint32_t stalls;         // buffer writes that waited for deferred storage work
+        uint32_t dtDropped;      // buffer time corrections dropped (timestamps off)
+        uint32_t hits[CHANNELS];
+        uint64_t deadUs[CHANNELS];
+    };
+    uint64_t _slots;
+    uint32_t _lostSeen;          // _acq.overflows() when last checked
+    uint32_t _lostInSnap;
+    uint16_t _maxBacklog;        // since "stats reset"
+    uint16_t _periodBacklog;     // this record period
+    StatCounters _statsBase;
+    StatCounters _statsPeriod;
+    uint16_t _statsFrameSeq;
 
     // Private methods
     void updateLED();
     void sampleAndStream();
+    void serviceSnap();
+    bool snapWindowFits(unsigned long preMs, unsigned long postMs);
+    void listHits();
+    uint8_t processSample(size_t ch, uint16_t raw, uint32_t now_us);  // returns hit flag
+    SampleBuffer& buffer() { return _sampleBuffer[_layer]; }
+    void streamBinary(uint32_t now_us, uint16_t raw, uint8_t hit);
+    void flushBatch();
+    void resetEvents(uint32_t now_us);
+    void streamEvent(uint32_t now_us, uint16_t raw, uint8_t hit);
+    void sendEvent();
+    void sendSummary(uint32_t now_us);
+    void sendCoincidences(uint32_t horizon_us);
+    void printCoincidenceCounts();
+    void setDetection(const char* args);
+    void printDetection();
+    void sendPulse(SEEsPulse& pulse);
+    void sendHistogram();
+    void printHistogram(const SEEsHistogram& hist);
+    StatCounters statCounters() const;
+    void trackStats(uint32_t backlog);
+    void sendStats(uint32_t now_us);
+    void printStats();
 };
 
 #endif // SEES_ADC_HPP
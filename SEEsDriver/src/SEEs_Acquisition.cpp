@@ -0,0 +1,219 @@
+/**
+ * @file SEEs_Acquisition.cpp
+ * @brief Implementation of timer/DMA-driven ADC acquisition
+ */
+
+#include "SEEs_Acquisition.hpp"
+
+#ifdef SEES_ACQ_DMA
+// Ping-pong DMA targets. DMAMEM (OCRAM) is cached, so each filled buffer is
+// invalidated before it is read.
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+    dmaBuffer0[SEEs_Acquisition::BLOCK_SAMPLES];
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+    dmaBuffer1[SEEs_Acquisition::BLOCK_SAMPLES];
+#if SEES_CHANNELS > 1
+// Channel 1 (ADC2)
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+    dmaBuffer2[SEEs_Acquisition::BLOCK_SAMPLES];
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+    dmaBuffer3[SEEs_Acquisition::BLOCK_SAMPLES];
+#endif
+#elif !defined(SEES_ACQ_POLLED)
+SEEs_Acquisition* SEEs_Acquisition::_instance = nullptr;
+#endif
+
+SEEs_Acquisition::SEEs_Acquisition(uint8_t adcPin)
+    : _periodUs(0), _startUs(0), _overflows(0), _overruns(0)
+#ifdef SEES_ACQ_DMA
+      , _dma0(dmaBuffer0, BLOCK_SAMPLES, dmaBuffer1, BLOCK_SAMPLES)
+#if SEES_CHANNELS > 1
+      , _dma1(dmaBuffer2, BLOCK_SAMPLES, dmaBuffer3, BLOCK_SAMPLES)
+#endif
+      , _buffersTaken(0)
+#else
+      , _carry(), _hasCarry(false), _slot(0)
+#endif
+{
+    const uint8_t pins[] = {SEES_ADC_PINS};
+    static_assert(sizeof(pins) >= SEES_CHANNELS, "SEES_ADC_PINS lists fewer pins than SEES_CHANNELS");
+    _pins[0] = adcPin;
+    for (size_t ch = 1; ch < CHANNELS; ch++) _pins[ch] = pins[ch];
+
+#ifdef SEES_ACQ_DMA
+    _dma[0] = &_dma0;
+#if SEES_CHANNELS > 1
+    _dma[1] = &_dma1;
+#endif
+#endif
+}
+
+bool SEEs_Acquisition::begin(uint32_t periodUs, int adcBits, int adcAveraging) {
+    _periodUs = periodUs;
+    _overflows = 0;
+    _overruns = 0;
+
+#ifdef SEES_ACQ_DMA
+    ADC_Module* modules[2] = {_adc.adc0, _adc.adc1};
+    for (size_t ch = 0; ch < CHANNELS; ch++) {
+        ADC_Module* adc = modules[ch];
+        adc->setResolution(adcBits);
+        adc->setAveraging(adcAveraging);
+        adc->setConversionSpeed(ADC_CONVERSION_SPEED::HIGH_SPEED);
+        adc->setSamplingSpeed(ADC_SAMPLING_SPEED::HIGH_SPEED);
+        _dma[ch]->init(&_adc, ch == 0 ? ADC_0 : ADC_1);
+        adc->startSingleRead(_pins[ch]);
+    }
+    _buffersTaken = 0;
+
+    // Hardware-timer triggered conversions, DMA'd into the ping-pong buffers.
+    // Both ADCs run at the same rate, started back to back.
+    _startUs = micros();
+    for (size_t ch = 0; ch < CHANNELS; ch++) {
+        modules[ch]->startTimer(1000000UL / periodUs);
+    }
+    return true;
+#else
+    analogReadResolution(adcBits);
+    analogReadAveraging(adcAveraging);
+    for (size_t ch = 0; ch < CHANNELS; ch++) {
+        (void)analogRead(_pins[ch]);  // Warm-up read
+    }
+
+    _queue.clear();
+    _hasCarry = false;
+    _slot = 0;
+    _startUs = micros();
+
+#ifdef SEES_ACQ_POLLED
+    _next_sample_us = _startUs;
+    return true;
+#else
+    _instance = this;
+    return _timer.begin(timerISR, periodUs);
+#endif
+#endif
+}
+
+void SEEs_Acquisition::end() {
+#if defined(SEES_ACQ_DMA)
+    _adc.adc0->stopTimer();
+    if (CHANNELS > 1) _adc.adc1->stopTimer();
+#elif !defined(SEES_ACQ_POLLED)
+    _timer.end();
+    _instance = nullptr;
+#endif
+}
+
+void SEEs_Acquisition::poll() {
+#ifdef SEES_ACQ_POLLED
+    uint32_t now_us = micros();
+    int32_t late = (int32_t)(now_us - _next_sample_us);
+    if (late < 0) return;
+
+    // Reading the missed slots back to back would stamp them with times they
+    // were not read at. Skip to the slot now due instead: nextBlock() starts
+    // a new block after the gap, so timestamps stay exact.
+    if (late > (int32_t)_periodUs) {
+        uint32_t missed = (uint32_t)late / _periodUs;
+        _slot = _slot + missed;
+        _next_sample_us += missed * _periodUs;
+        _overflows = _overflows + missed;
+        _overruns++;
+    }
+    _next_sample_us += _periodUs;
+    acquire();
+#endif
+}
+
+#if !defined(SEES_ACQ_DMA) && !defined(SEES_ACQ_POLLED)
+void SEEs_Acquisition::timerISR() {
+    if (_instance) _instance->acquire();
+}
+#endif
+
+#ifndef SEES_ACQ_DMA
+void SEEs_Acquisition::acquire() {
+    SlotSample s;
+    s.slot = _slot;
+    for (size_t ch = 0; ch < CHANNELS; ch++) {
+        s.adc[ch] = analogRead(_pins[ch]);
+    }
+    _slot = s.slot + 1;
+
+    if (!_queue.push(s)) {
+        _overflows = _overflows + 1;
+    }
+}
+#endif
+
+bool SEEs_Acquisition::nextBlock(SampleBlock& block) {
+#ifdef SEES_ACQ_DMA
+    // Channels fill their buffers in lockstep; wait until all have the same one
+    uint32_t filled = _dma[0]->interruptCount();
+    for (size_t ch = 0; ch < CHANNELS; ch++) {
+        if (!_dma[ch]->interrupted() || _dma[ch]->interruptCount() != filled) return false;
+    }
+
+    size_t n = _dma[0]->bufferCountLastISRFilled();
+    for (size_t ch = 0; ch < CHANNELS; ch++) {
+        volatile uint16_t* buf = _dma[ch]->bufferLastISRFilled();
+        if ((uintptr_t)buf >= 0x20200000u) {
+            arm_dcache_delete((void*)buf, n * sizeof(uint16_t));
+        }
+        memcpy(_block[ch], (const void*)buf, n * sizeof(uint16_t));
+        _dma[ch]->clearInterrupt();
+        block.adc[ch] = _block[ch];
+    }
+
+    // Every DMA interrupt is one full buffer; more than one since the last
+    // call means a buffer was refilled before we got to it
+    uint32_t lost = filled - _buffersTaken - 1;
+    if (lost) _overflows = _overflows + lost * n;
+    _buffersTaken = filled;
+
+    block.n = n;
+    block.t0_us = _startUs + (filled - 1) * BLOCK_SAMPLES * _periodUs;
+    block.dt_us = _periodUs;
+    return true;
+#else
+    SlotSample s;
+    if (_hasCarry) {
+        s = _carry;
+        _hasCarry = false;
+    } else if (!_queue.pop(s)) {
+        return false;
+    }
+
+    uint32_t first = s.slot;
+    size_t n = 0;
+    do {
+        // Extend while slots are consecutive; a dropped slot starts a new block
+        if (s.slot != first + n) {
+            _carry = s;
+            _hasCarry = true;
+            break;
+        }
+        for (size_t ch = 0; ch < CHANNELS; ch++) {
+            _block[ch][n] = s.adc[ch];
+        }
+        n++;
+    } while (n < BLOCK_SAMPLES && _queue.pop(s));
+
+    for (size_t ch = 0; ch < CHANNELS; ch++) {
+        block.adc[ch] = _block[ch];
+    }
+    block.n = n;
+    block.t0_us = _startUs + first * _periodUs;
+    block.dt_us = _periodUs;
+    return true;
+#endif
+}
+
+size_t SEEs_Acquisition::pending() {
+#ifdef SEES_ACQ_DMA
+    return _dma[0]->interrupted() ? BLOCK_SAMPLES : 0;
+#else
+    return _queue.size() + (_hasCarry ? 1 : 0);
+#endif
+}
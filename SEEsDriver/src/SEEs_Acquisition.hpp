@@ -0,0 +1,144 @@
+/**
+ * @file SEEs_Acquisition.hpp
+ * @brief Timer/DMA-driven ADC acquisition for SEEs
+ *
+ * Samples are taken on a fixed grid of "slots" (slot N is at
+ * start + N * period) and handed to loop() as blocks of consecutive
+ * readings. A block never spans a gap, so its timestamps are exact.
+ * Each slot reads every channel (SEES_CHANNELS); a block carries one
+ * lane of readings per channel.
+ *
+ * Back-ends (build flags):
+ *   (default)       - IntervalTimer ISR reads the ADC into a lock-free SPSC queue
+ *                     (channels read back to back, a few µs apart)
+ *   SEES_ACQ_DMA    - ADC hardware timer + DMA into ping-pong buffers (Teensy 4.1);
+ *                     a second channel runs on ADC2, converting simultaneously
+ *   SEES_ACQ_POLLED - legacy polled sampling from loop() (no timer); when
+ *                     loop() falls more than a period behind it skips to
+ *                     the current slot, and the skipped slots count as lost
+ */
+
+#ifndef SEES_ACQUISITION_HPP
+#define SEES_ACQUISITION_HPP
+
+#include <Arduino.h>
+#include "SampleQueue.hpp"
+#include "SEEs_Channels.hpp"
+
+#ifdef SEES_ACQ_DMA
+#include <ADC.h>
+#include <AnalogBufferDMA.h>
+#endif
+
+/**
+ * @brief Consecutive raw ADC readings on the sample grid
+ */
+struct SampleBlock {
+    const uint16_t* adc[SEES_CHANNELS];  // per channel: n raw 12-bit ADC values
+    size_t n;
+    uint32_t t0_us;       // micros() time of adc[0]
+    uint32_t dt_us;       // spacing between readings
+};
+
+class SEEs_Acquisition {
+public:
+    static constexpr size_t BLOCK_SAMPLES = 256;  // max readings per block (one DMA buffer)
+    static constexpr size_t QUEUE_DEPTH = 2048;   // slots; ~200 ms of slack at 10 kS/s
+    static constexpr size_t CHANNELS = SEES_CHANNELS;
+
+    /**
+     * @brief Construct acquisition engine
+     * @param adcPin ADC pin of channel 0; channels 1.. use SEES_ADC_PINS
+     */
+    explicit SEEs_Acquisition(uint8_t adcPin);
+
+    /**
+     * @brief Configure the ADC and start sampling
+     * @param periodUs Sample period in microseconds
+     * @param adcBits ADC resolution
+     * @param adcAveraging Hardware averaging (1 = off)
+     * @return true if the timer started
+     */
+    bool begin(uint32_t periodUs, int adcBits, int adcAveraging);
+
+    /**
+     * @brief Stop sampling
+     */
+    void end();
+
+    /**
+     * @brief Service the acquisition from loop()
+     *
+     * Timer/DMA build: no-op. Polled build: takes any due samples.
+     */
+    void poll();
+
+    /**
+     * @brief Take the next block of readings
+     * @param block Filled on success; valid until the next call
+     * @return false if nothing is pending
+     */
+    bool nextBlock(SampleBlock& block);
+
+    /**
+     * @brief Readings waiting to be processed
+     */
+    size_t pending();
+
+    /**
+     * @brief Readings lost because loop() fell behind (queue/DMA overrun,
+     *        or slots skipped by the polled build)
+     */
+    uint32_t overflows() const { return _overflows; }
+
+    /**
+     * @brief Times the polled build fell more than a period behind and
+     *        skipped ahead (the timer and DMA back-ends are hardware-paced)
+     */
+    uint32_t overruns() const { return _overruns; }
+
+    uint32_t periodUs() const { return _periodUs; }
+
+private:
+    uint8_t _pins[CHANNELS];
+    uint32_t _periodUs;
+    uint32_t _startUs;
+    volatile uint32_t _overflows;
+    uint32_t _overruns;
+
+    // Block handed out by nextBlock()
+    uint16_t _block[CHANNELS][BLOCK_SAMPLES];
+
+#ifdef SEES_ACQ_DMA
+    ADC _adc;
+    AnalogBufferDMA _dma0;
+#if SEES_CHANNELS > 1
+    AnalogBufferDMA _dma1;
+#endif
+    AnalogBufferDMA* _dma[CHANNELS];
+    uint32_t _buffersTaken;
+#else
+    // One slot's readings and the grid slot they were taken in
+    struct SlotSample {
+        uint32_t slot;
+        uint16_t adc[CHANNELS];
+    };
+
+    SampleQueue<SlotSample, QUEUE_DEPTH> _queue;
+    SlotSample _carry;  // first reading of the next block (after a gap)
+    bool _hasCarry;
+    volatile uint32_t _slot;
+
+    void acquire();
+#endif
+
+#ifdef SEES_ACQ_POLLED
+    uint32_t _next_sample_us;
+#elif !defined(SEES_ACQ_DMA)
+    IntervalTimer _timer;
+    static SEEs_Acquisition* _instance;
+    static void timerISR();
+#endif
+};
+
+#endif // SEES_ACQUISITION_HPP
@@ -0,0 +1,35 @@
+/**
+ * @file SEEs_Channels.hpp
+ * @brief Detector channel (scintillator layer) configuration
+ *
+ * Every sample slot reads all channels, so the layers share one timebase.
+ *
+ *   SEES_CHANNELS  - channels sampled per slot, layer 0 first (default 1, max 4)
+ *   SEES_ADC_PINS  - pins for layers 1.. (layer 0 is the SEEs_ADC adcPin)
+ *
+ * Buffer windows and pools default to an even split of the RAM/PSRAM
+ * budget across the channels (SampleBuffer.hpp, SampleStorage.hpp).
+ */
+
+#ifndef SEES_CHANNELS_HPP
+#define SEES_CHANNELS_HPP
+
+#include <Arduino.h>
+
+#ifndef SEES_CHANNELS
+#define SEES_CHANNELS 1
+#endif
+
+#ifndef SEES_ADC_PINS
+#define SEES_ADC_PINS A0, A1, A2, A3
+#endif
+
+static constexpr size_t SEES_MAX_CHANNELS = 4;
+static_assert(SEES_CHANNELS >= 1 && SEES_CHANNELS <= SEES_MAX_CHANNELS,
+              "SEES_CHANNELS must be 1..4");
+
+#if defined(SEES_ACQ_DMA) && SEES_CHANNELS > 2
+#error "SEES_ACQ_DMA samples at most 2 channels (one per ADC); use the timer back-end"
+#endif
+
+#endif // SEES_CHANNELS_HPP
@@ -0,0 +1,67 @@
+/**
+ * @file SEEs_Coincidence.cpp
+ * @brief Implementation of layer coincidence detection
+ */
+
+#include "SEEs_Coincidence.hpp"
+
+SEEs_Coincidence::SEEs_Coincidence(uint32_t windowUs)
+    : _windowUs(windowUs), _pendingCount(0), _dropped(0) {
+    reset();
+}
+
+void SEEs_Coincidence::setWindow(uint32_t windowUs) {
+    _windowUs = windowUs;
+    _pendingCount = 0;
+}
+
+void SEEs_Coincidence::reset() {
+    _pendingCount = 0;
+    _dropped = 0;
+    for (size_t d = 0; d <= SEES_MAX_CHANNELS; d++) _counts[d] = 0;
+}
+
+void SEEs_Coincidence::addHit(uint8_t layer, uint32_t t_us) {
+    if (_pendingCount == MAX_PENDING) {
+        _dropped++;
+        return;
+    }
+
+    // Insertion keeps the list time-ordered; hits mostly arrive in order
+    size_t i = _pendingCount++;
+    while (i > 0 && (int32_t)(_pending[i - 1].t_us - t_us) > 0) {
+        _pending[i] = _pending[i - 1];
+        i--;
+    }
+    _pending[i] = {t_us, layer};
+}
+
+bool SEEs_Coincidence::next(uint32_t horizonUs, SEEsCoincidence& out) {
+    if (_pendingCount == 0) return false;
+
+    // Any later hit is after horizonUs, so beyond the window of this one
+    uint32_t first = _pending[0].t_us;
+    if ((int32_t)(horizonUs - first) < (int32_t)_windowUs) return false;
+
+    uint8_t mask = 0;
+    uint32_t last = first;
+    size_t n = 0;
+    while (n < _pendingCount && _pending[n].t_us - first <= _windowUs) {
+        mask |= 1 << _pending[n].layer;
+        last = _pending[n].t_us;
+        n++;
+    }
+
+    uint8_t depth = 0;
+    while (depth < SEES_CHANNELS && (mask >> depth) & 1) depth++;
+
+    out.t_us = first;
+    out.spread_us = (last - first > 0xFFFF) ? 0xFFFF : (uint16_t)(last - first);
+    out.layer_mask = mask;
+    out.depth = depth;
+    _counts[depth]++;
+
+    for (size_t i = n; i < _pendingCount; i++) _pending[i - n] = _pending[i];
+    _pendingCount -= n;
+    return true;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file SEEs_Coincidence.hpp
+ * @brief On-device coincidence detection across detector layers
+ *
+ * Per-layer hits are merged into one event when they fall within a window
+ * of the event's first hit. The event's depth classifies how far the
+ * particle penetrated the stack: depth N means layers 0..N-1 all fired
+ * (depth 0: layer 0 did not fire, e.g. noise or side entry).
+ *
+ * Hits may arrive out of order within a block (SEEs_ADC runs one layer
+ * at a time); an event is only closed once no later hit can join it.
+ */
+
+#ifndef SEES_COINCIDENCE_HPP
+#define SEES_COINCIDENCE_HPP
+
+#include <Arduino.h>
+#include "SEEs_Channels.hpp"
+#include "SEEs_Interface.hpp"
+
+class SEEs_Coincidence {
+public:
+    static constexpr size_t MAX_PENDING = 64;  // hits awaiting their window
+
+    /**
+     * @brief Construct coincidence engine
+     * @param windowUs Hits within this many µs of an event's first hit join it
+     */
+    explicit SEEs_Coincidence(uint32_t windowUs);
+
+    /**
+     * @brief Change the window (drops pending hits)
+     */
+    void setWindow(uint32_t windowUs);
+
+    uint32_t windowUs() const { return _windowUs; }
+
+    /**
+     * @brief Add a layer hit
+     * @param layer Layer index (0 = top of the stack)
+     * @param t_us micros() of the hit sample
+     */
+    void addHit(uint8_t layer, uint32_t t_us);
+
+    /**
+     * @brief Take the next closed event
+     * @param horizonUs Time of the newest processed sample on every layer
+     * @param out Filled on success (t_us in micros())
+     * @return false if no event is complete yet
+     */
+    bool next(uint32_t horizonUs, SEEsCoincidence& out);
+
+    /**
+     * @brief Events classified at a depth since the last reset
+     */
+    uint32_t count(uint8_t depth) const { return depth <= SEES_MAX_CHANNELS ? _counts[depth] : 0; }
+
+    /**
+     * @brief Hits dropped because too many were pending
+     */
+    uint32_t dropped() const { return _dropped; }
+
+    void reset();
+
+private:
+    struct PendingHit {
+        uint32_t t_us;
+        uint8_t layer;
+    };
+
+    uint32_t _windowUs;
+    PendingHit _pending[MAX_PENDING];  // sorted by time
+    size_t _pendingCount;
+    uint32_t _counts[SEES_MAX_CHANNELS + 1];
+    uint32_t _dropped;
+};
+
+#endif // SEES_COINCIDENCE_HPP
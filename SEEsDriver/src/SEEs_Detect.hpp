@@ -0,0 +1,188 @@
+/**
+ * @file SEEs_Detect.hpp
+ * @brief Integer hit detector (windowed threshold, hysteresis, refractory)
+ *
+ * Thresholds are raw ADC counts, converted from volts once at build or
+ * config time, so the per-sample path is a few integer compares.
+ * sees_counts_at_least()/sees_counts_above() reproduce the float compare
+ * `raw * voltsPerCount >= volts` exactly, so hit decisions are identical
+ * to comparing converted voltages.
+ *
+ * Relative mode adds a tracked baseline (SEEs_Baseline) to the thresholds,
+ * optionally raised to a multiple of the tracked noise, so drift from
+ * temperature or SiPM dark current does not move the effective threshold.
+ */
+
+#ifndef SEES_DETECT_HPP
+#define SEES_DETECT_HPP
+
+#include <stdint.h>
+
+/**
+ * @brief Smallest count c with `c * voltsPerCount >= volts` (maxCount + 1 if none)
+ */
+constexpr uint16_t sees_counts_at_least(float volts, float voltsPerCount, uint16_t maxCount) {
+    uint16_t c = 0;
+    while (c <= maxCount && c * voltsPerCount < volts) c++;
+    return c;
+}
+
+/**
+ * @brief Smallest count c with `c * voltsPerCount > volts` (maxCount + 1 if none)
+ */
+constexpr uint16_t sees_counts_above(float volts, float voltsPerCount, uint16_t maxCount) {
+    uint16_t c = 0;
+    while (c <= maxCount && c * voltsPerCount <= volts) c++;
+    return c;
+}
+
+/**
+ * @brief Detection settings as configured (the "set" command), in mV / µs
+ */
+struct SEEsDetectConfig {
+    uint16_t enter_mv;
+    uint16_t upper_mv;
+    uint16_t exit_mv;
+    uint32_t refract_us;
+    uint8_t  baseline;       // 1: thresholds are relative to the tracked baseline
+    uint16_t sigma_tenths;   // relative mode: enter/exit at least this many σ/10 (0 = off)
+    uint8_t  filter;         // shaping before detection (SEEsFilterShape, SEEs_Filter.hpp)
+    uint16_t pileup_mv;      // dip between two peaks of one pulse (SEEs_Pulse, 0 = off)
+};
+
+struct SEEsThresholds {
+    uint16_t enter_adc;      // hit if enter_adc <= adc <= upper_adc ...
+    uint16_t upper_adc;
+    uint16_t exit_adc;       // ... re-arm once adc < exit_adc
+    uint32_t refract_us;     // min time between hits
+    uint8_t  relative;       // counts above the baseline instead of absolute
+    uint16_t sigma_tenths;   // relative: enter/exit raised to this many σ/10
+};
+
+/**
+ * @brief Integer EMA of the baseline and its mean absolute deviation
+ *
+ * Fed only with armed, non-hit samples - SEEs_Detector passes every
+ * UPDATE_EVERY-th one, so the time constant is 2^SHIFT x UPDATE_EVERY
+ * samples (~100 ms at 10 kHz). Unsigned adds and shifts only, so every
+ * build computes the same values.
+ */
+class SEEs_Baseline {
+public:
+    static constexpr uint8_t SHIFT = 8;
+    static constexpr uint32_t UPDATE_EVERY = 4;
+
+    SEEs_Baseline() : _acc(0), _devAcc(0), _seeded(false) {}
+
+    void reset() { _seeded = false; }
+
+    void update(uint16_t adc) {
+        if (!_seeded) {
+            _acc = (uint32_t)adc << SHIFT;  // start at the first sample, not 0
+            _devAcc = 0;
+            _seeded = true;
+            return;
+        }
+        uint16_t b = value();
+        uint32_t dev = adc > b ? adc - b : b - adc;
+        _acc += adc - (_acc >> SHIFT);      // modulo arithmetic, result stays >= 0
+        _devAcc += dev - (_devAcc >> SHIFT);
+    }
+
+    uint16_t value() const { return _acc >> SHIFT; }
+
+    /** @brief Baseline in 1/16 counts */
+    uint32_t value16() const { return _acc >> (SHIFT - 4); }
+
+    /** @brief Noise σ in 1/16 counts (σ ≈ 1.2533 x mean absolute deviation) */
+    uint32_t noise16() const { return ((_devAcc >> (SHIFT - 4)) * 1283) >> 10; }
+
+    /** @brief tenths/10 σ in whole counts */
+    uint16_t sigmaCounts(uint16_t tenths) const { return (uint16_t)((tenths * noise16()) / 160); }
+
+private:
+    uint32_t _acc;           // baseline << SHIFT
+    uint32_t _devAcc;        // mean |adc - baseline| << SHIFT
+    bool _seeded;
+};
+
+class SEEs_Detector {
+public:
+    enum class Step : uint8_t {
+        Armed,               // waiting for a pulse
+        Hit,                 // this sample is a hit - now disarmed
+        Pulse,               // still above the exit threshold
+        Rearm                // dropped below it - armed again
+    };
+
+    static constexpr uint32_t RETUNE_SAMPLES = 64;  // relative thresholds refresh (baseline moves slowly)
+    static_assert(RETUNE_SAMPLES % SEEs_Baseline::UPDATE_EVERY == 0, "retune on a baseline update");
+
+    SEEs_Detector() : _armed(true), _lastHitUs(0), _enter(0), _upper(0), _exit(0), _retune(0) {}
+
+    Step step(uint16_t adc, uint32_t now_us, const SEEsThresholds& th) {
+        if (th.relative) return stepRelative(adc, now_us, th);
+
+        if (_armed) {
+            if (adc >= th.enter_adc && adc <= th.upper_adc &&
+                (now_us - _lastHitUs) >= th.refract_us) {
+                _armed = false;  // Disarm until voltage drops
+                _lastHitUs = now_us;
+                return Step::Hit;
+            }
+            return Step::Armed;
+        }
+        if (adc < th.exit_adc) {
+            _armed = true;
+            return Step::Rearm;
+        }
+        return Step::Pulse;
+    }
+
+    const SEEs_Baseline& baseline() const { return _baseline; }
+    void resetBaseline() { _baseline.reset(); _retune = 0; }
+
+    /** @brief Recompute relative thresholds on the next sample (after a config change) */
+    void retune() { _retune = 0; }
+
+private:
+    bool _armed;
+    uint32_t _lastHitUs;
+    SEEs_Baseline _baseline;
+    uint32_t _enter;         // relative mode: absolute thresholds for the current baseline
+    uint32_t _upper;
+    uint32_t _exit;
+    uint32_t _retune;        // samples until they are recomputed
+
+    // Out of line so the absolute path stays small enough to inline
+    __attribute__((noinline))
+    Step stepRelative(uint16_t adc, uint32_t now_us, const SEEsThresholds& th) {
+        if (_retune == 0) retuneThresholds(th);
+
+        if (_armed) {
+            if (adc >= _enter && adc <= _upper && (now_us - _lastHitUs) >= th.refract_us) {
+                _armed = false;
+                _lastHitUs = now_us;
+                return Step::Hit;
+            }
+            if (--_retune % SEEs_Baseline::UPDATE_EVERY == 0) _baseline.update(adc);
+            return Step::Armed;
+        }
+        if (adc < _exit) {
+            _armed = true;
+            return Step::Rearm;
+        }
+        return Step::Pulse;
+    }
+
+    void retuneThresholds(const SEEsThresholds& th) {
+        uint32_t base = _baseline.value();
+        uint32_t floor = th.sigma_tenths ? _baseline.sigmaCounts(th.sigma_tenths) : 0;
+        _enter = base + (th.enter_adc > floor ? th.enter_adc : floor);
+        _upper = base + th.upper_adc;
+        _exit = base + (th.exit_adc > floor ? th.exit_adc : floor);
+        _retune = RETUNE_SAMPLES;
+    }
+};
+
+#endif // SEES_DETECT_HPP
@@ -0,0 +1,117 @@
+/**
+ * @file SEEs_Filter.hpp
+ * @brief FIR pulse-shaping filter between the ADC and the hit detector
+ *
+ * Fixed-point FIR with a compile-time tap count, so the convolution loop
+ * fully unrolls. Coefficients are Q12 and sum to 1.0, so the output stays
+ * in ADC counts and the detection thresholds apply unchanged.
+ *
+ *   SEES_FILTER_TAPS - taps per layer (default 8)
+ *
+ * Kernels (selected at run time with "set filter"):
+ *   Box       - moving average over all taps (noise spikes averaged out)
+ *   Trapezoid - rising ramp, flat top, falling ramp over the taps: a short
+ *               pulse comes out as a trapezoid, smoothing without the box's
+ *               sharp edges
+ *
+ * Only the detector sees the shaped signal; recorded and streamed samples
+ * stay raw. An N-tap kernel delays hits by about (N-1)/2 samples.
+ */
+
+#ifndef SEES_FILTER_HPP
+#define SEES_FILTER_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef SEES_FILTER_TAPS
+#define SEES_FILTER_TAPS 8
+#endif
+
+static_assert(SEES_FILTER_TAPS >= 2 && SEES_FILTER_TAPS <= 64, "SEES_FILTER_TAPS must be 2..64");
+
+enum class SEEsFilterShape : uint8_t { Off, Box, Trapezoid };
+
+template <size_t TAPS>
+struct SEEs_FirKernel {
+    static constexpr uint8_t Q = 12;  // coefficients sum to 1 << Q
+
+    int16_t c[TAPS];                  // c[0] weights the newest sample
+
+    /**
+     * @brief Build a kernel (Off builds a unit impulse)
+     */
+    static SEEs_FirKernel make(SEEsFilterShape shape) {
+        SEEs_FirKernel k;
+        uint32_t w[TAPS];
+        for (size_t i = 0; i < TAPS; i++) {
+            if (shape == SEEsFilterShape::Box) {
+                w[i] = 1;
+            } else if (shape == SEEsFilterShape::Trapezoid) {
+                // Ramps of TAPS/3 taps on either side of the flat top
+                size_t ramp = TAPS / 3 ? TAPS / 3 : 1;
+                size_t edge = i < TAPS - 1 - i ? i : TAPS - 1 - i;
+                w[i] = edge < ramp ? edge + 1 : ramp + 1;
+            } else {
+                w[i] = i == 0;
+            }
+        }
+
+        // Normalize to 1 << Q; the rounding remainder goes to the largest tap
+        uint32_t total = 0;
+        for (size_t i = 0; i < TAPS; i++) total += w[i];
+        int32_t sum = 0;
+        size_t largest = 0;
+        for (size_t i = 0; i < TAPS; i++) {
+            k.c[i] = (int16_t)((w[i] << Q) / total);
+            sum += k.c[i];
+            if (w[i] > w[largest]) largest = i;
+        }
+        k.c[largest] += (int16_t)((1 << Q) - sum);
+        return k;
+    }
+};
+
+template <size_t TAPS>
+class SEEs_FirFilter {
+public:
+    SEEs_FirFilter() : _pos(0), _primed(false) {}
+
+    /**
+     * @brief Restart; the next sample fills the delay line
+     */
+    void reset() { _primed = false; }
+
+    /**
+     * @brief Filter one sample
+     * @return Shaped sample in ADC counts (clamped to 0..maxAdc)
+     */
+    uint16_t push(uint16_t adc, const SEEs_FirKernel<TAPS>& kernel, uint16_t maxAdc) {
+        if (!_primed) {
+            // Start from a flat line at the first sample, not from 0
+            for (size_t i = 0; i < 2 * TAPS; i++) _line[i] = adc;
+            _primed = true;
+        }
+
+        // Doubled ring: the newest TAPS samples are always contiguous from _pos
+        _pos = _pos == 0 ? TAPS - 1 : _pos - 1;
+        _line[_pos] = adc;
+        _line[_pos + TAPS] = adc;
+
+        const uint16_t* x = &_line[_pos];
+        int32_t acc = 1 << (SEEs_FirKernel<TAPS>::Q - 1);  // round to nearest
+#pragma GCC unroll 64
+        for (size_t i = 0; i < TAPS; i++) acc += kernel.c[i] * (int32_t)x[i];
+
+        acc >>= SEEs_FirKernel<TAPS>::Q;
+        if (acc < 0) return 0;
+        return acc > maxAdc ? maxAdc : (uint16_t)acc;
+    }
+
+private:
+    uint16_t _line[2 * TAPS];
+    size_t _pos;
+    bool _primed;
+};
+
+#endif // SEES_FILTER_HPP
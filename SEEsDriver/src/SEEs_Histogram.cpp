@@ -0,0 +1,74 @@
+/**
+ * @file SEEs_Histogram.cpp
+ * @brief Implementation of the pulse peak histogram
+ */
+
+#include "SEEs_Histogram.hpp"
+
+SEEs_Histogram::SEEs_Histogram(uint16_t minAdc, uint16_t maxAdc, uint32_t windowUs)
+    : _minAdc(minAdc),
+      _binAdc(binWidth(minAdc, maxAdc)),
+      _windowUs(windowUs), _windowStart(0), _active(0), _ready(false) {
+    start(0);
+}
+
+void SEEs_Histogram::start(uint32_t now_us) {
+    clearBank(_bank[0]);
+    clearBank(_bank[1]);
+    _active = 0;
+    _ready = false;
+    _windowStart = now_us;
+}
+
+void SEEs_Histogram::setWindow(uint32_t windowUs, uint32_t now_us) {
+    _windowUs = windowUs;
+    clearBank(_bank[_active]);
+    _windowStart = now_us;
+}
+
+void SEEs_Histogram::setRange(uint16_t minAdc, uint16_t maxAdc, uint32_t now_us) {
+    uint16_t binAdc = binWidth(minAdc, maxAdc);
+    if (minAdc == _minAdc && binAdc == _binAdc) return;
+
+    // Counts binned on the old edges would be mislabelled
+    _minAdc = minAdc;
+    _binAdc = binAdc;
+    clearBank(_bank[_active]);
+    _windowStart = now_us;
+}
+
+void SEEs_Histogram::add(uint8_t layer, uint16_t peakAdc) {
+    size_t bin = peakAdc > _minAdc ? (peakAdc - _minAdc) / _binAdc : 0;
+    if (bin >= SEES_HIST_BINS) bin = SEES_HIST_BINS - 1;
+
+    SEEsHistogram& bank = _bank[_active];
+    if (bank.counts[layer][bin] != 0xFFFF) bank.counts[layer][bin]++;
+}
+
+bool SEEs_Histogram::roll(uint32_t now_us) {
+    if ((int32_t)(now_us - _windowStart) < (int32_t)_windowUs) return false;
+
+    // Windows stay on a fixed grid unless processing fell a whole window behind
+    SEEsHistogram& done = _bank[_active];
+    done.t_us = _windowStart + _windowUs;
+    done.window_us = _windowUs;
+    _windowStart = done.t_us;
+    if ((int32_t)(now_us - _windowStart) >= (int32_t)_windowUs) _windowStart = now_us;
+
+    _active ^= 1;
+    clearBank(_bank[_active]);
+    _ready = true;
+    return true;
+}
+
+void SEEs_Histogram::clearBank(SEEsHistogram& bank) {
+    memset(&bank, 0, sizeof(bank));
+    bank.layers = SEES_CHANNELS;
+    bank.bins = SEES_HIST_BINS;
+    bank.min_adc = _minAdc;
+    bank.bin_adc = _binAdc;
+}
+
+uint16_t SEEs_Histogram::binWidth(uint16_t minAdc, uint16_t maxAdc) {
+    return (uint16_t)((maxAdc - minAdc + SEES_HIST_BINS) / SEES_HIST_BINS);
+}
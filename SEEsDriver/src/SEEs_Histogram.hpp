@@ -0,0 +1,83 @@
+/**
+ * @file SEEs_Histogram.hpp
+ * @brief Pulse peak histogram per layer over fixed integration windows
+ *
+ * The on-board replacement for the FPGA's counts[layer][energy_bin]:
+ * every pulse's peak ADC value is binned for its layer, and a complete
+ * histogram is produced once per window whatever the event rate.
+ *
+ * Double-buffered: the finished window stays readable (and can be sent)
+ * while the next one accumulates in the other bank.
+ */
+
+#ifndef SEES_HISTOGRAM_HPP
+#define SEES_HISTOGRAM_HPP
+
+#include <Arduino.h>
+#include "SEEs_Channels.hpp"
+#include "SEEs_Interface.hpp"
+
+static_assert(SEES_CHANNELS <= SEES_HIST_LAYERS, "histogram holds at most 4 layers");
+
+class SEEs_Histogram {
+public:
+    /**
+     * @brief Construct histogram
+     * @param minAdc Lower edge of bin 0 (peaks below land in bin 0)
+     * @param maxAdc Upper edge of the last bin (peaks above land in it)
+     * @param windowUs Integration window
+     */
+    SEEs_Histogram(uint16_t minAdc, uint16_t maxAdc, uint32_t windowUs);
+
+    /**
+     * @brief Clear both banks and start a window at now_us
+     */
+    void start(uint32_t now_us);
+
+    /**
+     * @brief Change the window length (restarts the current window)
+     */
+    void setWindow(uint32_t windowUs, uint32_t now_us);
+
+    uint32_t windowUs() const { return _windowUs; }
+
+    /**
+     * @brief Move the bin edges (restarts the current window if they change)
+     * @param minAdc Lower edge of bin 0
+     * @param maxAdc Upper edge of the last bin
+     */
+    void setRange(uint16_t minAdc, uint16_t maxAdc, uint32_t now_us);
+
+    /**
+     * @brief Count a pulse
+     * @param layer Layer index
+     * @param peakAdc Pulse peak (raw ADC)
+     */
+    void add(uint8_t layer, uint16_t peakAdc);
+
+    /**
+     * @brief Close the window if it has elapsed
+     * @return true if a window was completed (see completed())
+     */
+    bool roll(uint32_t now_us);
+
+    /**
+     * @brief Last completed window (t_us in micros())
+     * @return nullptr until the first window completes
+     */
+    const SEEsHistogram* completed() const { return _ready ? &_bank[_active ^ 1] : nullptr; }
+
+private:
+    uint16_t _minAdc;
+    uint16_t _binAdc;
+    uint32_t _windowUs;
+    uint32_t _windowStart;
+    SEEsHistogram _bank[2];
+    uint8_t _active;           // bank being filled
+    bool _ready;
+
+    void clearBank(SEEsHistogram& bank);
+    static uint16_t binWidth(uint16_t minAdc, uint16_t maxAdc);
+};
+
+#endif // SEES_HISTOGRAM_HPP
@@ -18,6 +18,32 @@ uint16_t crc16_ccitt(const uint8_t *data, size_t len) {
     return crc;
 }
 
+// -------------------------
+// Frame encoder
+// -------------------------
+size_t sees_frame_encode(uint8_t type, uint16_t seq,
+                         const void *payload, uint16_t len,
+                         uint8_t *out, size_t out_cap) {
+    size_t total = sizeof(SEEsFrameHeader) + len + 2;
+    if (len > SEES_FRAME_MAX_PAYLOAD || total > out_cap) return 0;
+
+    SEEsFrameHeader hdr;
+    hdr.sync[0] = SEES_FRAME_SYNC0;
+    hdr.sync[1] = SEES_FRAME_SYNC1;
+    hdr.type = type;
+    hdr.reserved = 0;
+    hdr.seq = seq;
+    hdr.length = len;
+
+    memcpy(out, &hdr, sizeof(hdr));
+    memcpy(out + sizeof(hdr), payload, len);
+
+    uint16_t crc = crc16_ccitt(out, sizeof(hdr) + len);
+    out[sizeof(hdr) + len] = crc & 0xFF;
+    out[sizeof(hdr) + len + 1] = crc >> 8;
+    return total;
+}
+
 // -------------------------
 // Internal ring buffer
 // -------------------------
@@ -27,9 +27,175 @@ struct TelemetryFrame {
     uint16_t crc;
 } __attribute__((packed));
 
+// ---- Serial frames (binary streaming / telemetry) ----
+//
+// Wire layout: [SEEsFrameHeader][payload (length bytes)][crc16 LE]
+// CRC is crc16_ccitt over header + payload (sync bytes included).
+// Sync bytes are non-ASCII so frames can share the link with text lines.
+static constexpr uint8_t SEES_FRAME_SYNC0 = 0xA5;
+static constexpr uint8_t SEES_FRAME_SYNC1 = 0x5A;
+static constexpr size_t  SEES_FRAME_MAX_PAYLOAD = 1024;
+
+enum SEEsFrameType : uint8_t {
+    SEES_FRAME_SAMPLES     = 0x01,  // SEEsSampleBatch
+    SEES_FRAME_SNAP_HEADER = 0x02,  // SEEsSnapHeader
+    SEES_FRAME_SNAP_DATA   = 0x03,  // SEEsSnapData + SampleCodec block
+    SEES_FRAME_SNAP_END    = 0x04,  // SEEsSnapEnd
+    SEES_FRAME_EVENT       = 0x05,  // SEEsEventHeader + raw samples
+    SEES_FRAME_SUMMARY     = 0x06,  // SEEsSummary
+    SEES_FRAME_COINCIDENCE = 0x07,  // SEEsCoincidence
+    SEES_FRAME_HISTOGRAM   = 0x08,  // SEEsHistogram
+    SEES_FRAME_PULSE       = 0x09,  // SEEsPulse
+    SEES_FRAME_STATS       = 0x0A,  // SEEsStats
+};
+
+struct SEEsFrameHeader {
+    uint8_t  sync[2];
+    uint8_t  type;
+    uint8_t  reserved;
+    uint16_t seq;
+    uint16_t length;  // payload bytes
+} __attribute__((packed));
+
+// Raw sample batch for streaming mode (fixed size)
+static constexpr size_t SEES_STREAM_BATCH = 32;
+static constexpr uint16_t SEES_SAMPLE_HIT_BIT = 0x8000;  // bit 15, ADC is 12-bit
+
+struct SEEsSampleBatch {
+    uint32_t t0_us;       // timestamp of samples[0]: µs since the stream started
+                          // (SEEs_ADC::begin(), the text stream's time_ms origin);
+                          // wraps after ~71.6 min
+    uint16_t dt_us;       // sample period
+    uint16_t count;       // valid samples (== SEES_STREAM_BATCH except on flush or a gap)
+    uint32_t total_hits;  // cumulative hits after the last sample
+    uint16_t samples[SEES_STREAM_BATCH];  // adc_raw | (hit ? SEES_SAMPLE_HIT_BIT : 0)
+} __attribute__((packed));
+
+// Binary snap export: header, data frames in sample order, end.
+// Header/end frames use snap_id as seq; data frames have their own counter.
+static constexpr size_t SEES_SNAP_BLOCK_SAMPLES = 128;  // samples per data frame
+
+struct SEEsSnapHeader {
+    uint32_t snap_id;
+    uint32_t sample_count;  // samples in the snapshot
+    uint32_t end_us;        // time of the last sample (µs, same base as SEEsSampleBatch)
+    uint16_t dt_us;         // nominal sample period
+    uint8_t  adc_bits;
+    uint8_t  reserved;
+    float    adc_vref;      // volts = raw * adc_vref / (2^adc_bits - 1)
+} __attribute__((packed));
+
+struct SEEsSnapData {
+    uint32_t snap_id;
+    uint32_t first_index;   // snapshot index of the block's first sample (gaps = lost)
+    uint32_t first_us;      // time of the block's first sample from the snapshot's first (µs);
+                            // a gap too long for the 16-bit deltas always starts a block
+    // followed by one SampleCodec block (time delta of index 0 is unused)
+} __attribute__((packed));
+
+struct SEEsSnapEnd {
+    uint32_t snap_id;
+    uint32_t samples_sent;
+    uint32_t samples_lost;  // overwritten before they could be sent
+    uint32_t hits;
+} __attribute__((packed));
+
+// Event (zero-suppressed) streaming: one frame per pulse waveform, plus a
+// summary frame per period so baseline and rate stay visible between pulses
+static constexpr size_t SEES_EVENT_MAX_SAMPLES = 256;  // power of two (pre-trigger ring)
+
+struct SEEsEventHeader {
+    uint32_t event_id;
+    uint32_t t0_us;          // timestamp of samples[0] (same base as SEEsSampleBatch)
+    uint16_t dt_us;          // sample period
+    uint16_t count;          // samples that follow
+    uint16_t trigger_index;  // index of the hit that opened the event
+    uint16_t hits;           // hits inside the waveform
+    uint32_t total_hits;     // cumulative hits after the last sample
+    // followed by uint16_t samples[count]: adc_raw | (hit ? SEES_SAMPLE_HIT_BIT : 0)
+} __attribute__((packed));
+
+struct SEEsSummary {
+    uint32_t t_us;           // end of the period
+    uint32_t period_us;
+    uint32_t samples;        // samples acquired in the period
+    uint32_t hits;           // hits in the period
+    uint32_t total_hits;
+    uint32_t events;         // events sent since the mode was entered
+    float    baseline_adc;   // mean raw ADC over the period
+    float    noise_adc;      // RMS about the mean
+    uint32_t pileups;        // extra peaks inside pulses completed in the period
+    uint32_t dead_us;        // time disarmed or refractory, for those pulses
+} __attribute__((packed));
+
+// Layer coincidence (SEEs_Coincidence): one record per multi-layer event
+struct SEEsCoincidence {
+    uint32_t t_us;           // first hit (same base as SEEsSampleBatch)
+    uint16_t spread_us;      // last hit - first hit
+    uint8_t  layer_mask;     // bit n set if layer n fired
+    uint8_t  depth;          // layers 0..depth-1 all fired
+} __attribute__((packed));
+
+// Pulse peak histogram (SEEs_Histogram): one frame per integration window,
+// the layout of the FPGA's counts[layer][energy_bin]
+static constexpr size_t SEES_HIST_LAYERS = 4;
+static constexpr size_t SEES_HIST_BINS = 8;
+
+struct SEEsHistogram {
+    uint32_t t_us;           // end of the window (same base as SEEsSampleBatch)
+    uint32_t window_us;
+    uint8_t  layers;         // rows of counts in use (SEES_CHANNELS)
+    uint8_t  bins;
+    uint16_t min_adc;        // lower edge of bin 0 (raw ADC; counts above the baseline with "set baseline 1")
+    uint16_t bin_adc;        // bin width; the last bin also takes everything above
+    uint16_t counts[SEES_HIST_LAYERS][SEES_HIST_BINS];  // saturate at 0xFFFF
+} __attribute__((packed));
+
+// Pulse record (SEEs_Pulse): one per hit, sent when the layer re-arms.
+// Times are in µs on the sample grid and saturate at 0xFFFF.
+struct SEEsPulse {
+    uint32_t t_us;           // hit (threshold crossing, same base as SEEsSampleBatch)
+    uint32_t integral;       // sum of (adc - pedestal) over the pulse, ADC counts x samples
+    uint16_t peak_adc;       // raw
+    uint16_t pedestal_adc;   // sample before the hit
+    uint16_t rise_us;        // hit -> peak
+    uint16_t duration_us;    // hit -> re-arm (time over threshold)
+    uint8_t  layer;
+    uint8_t  peaks;          // maxima in the pulse; > 1 is pile-up (saturates at 255)
+} __attribute__((packed));
+
+// Dead/live time accounting: one frame per stats period, counts for that
+// period. Live time of layer n = period - dead_us[n] - the lost slots' time.
+static constexpr size_t SEES_STATS_LAYERS = 4;
+
+struct SEEsStats {
+    uint32_t t_us;           // end of the period (same base as SEEsSampleBatch)
+    uint32_t period_us;      // (slots + lost_slots) x sample period
+    uint32_t slots;          // sample slots processed
+    uint32_t lost_slots;     // dropped or skipped because loop() was too slow ...
+    uint32_t lost_in_snap;   // ... of which while a snap was running
+    uint32_t overruns;       // polled build: times it fell behind and skipped ahead
+    uint16_t max_backlog;    // deepest acquisition backlog seen, readings
+    uint8_t  layers;         // entries of hits/dead_us in use (SEES_CHANNELS)
+    uint8_t  reserved;
+    uint32_t hits[SEES_STATS_LAYERS];
+    uint32_t dead_us[SEES_STATS_LAYERS];  // detector: hit to re-arm or end of refractory
+    uint32_t dt_dropped;     // buffer time corrections dropped (those timestamps read nominal)
+} __attribute__((packed));
+
+static constexpr size_t SEES_FRAME_OVERHEAD = sizeof(SEEsFrameHeader) + 2;
+
 // ---- API ----
 uint16_t crc16_ccitt(const uint8_t *data, size_t len);
 
+/**
+ * @brief Encode a framed payload into out
+ * @return Encoded frame size, or 0 if it does not fit
+ */
+size_t sees_frame_encode(uint8_t type, uint16_t seq,
+                         const void *payload, uint16_t len,
+                         uint8_t *out, size_t out_cap);
+
 void sees_ingest(uint8_t byte);
 bool sees_poll();
 bool sees_next_frame(TelemetryFrame &out);
\ No newline at end of file
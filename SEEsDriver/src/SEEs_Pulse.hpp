@@ -0,0 +1,118 @@
+/**
+ * @file SEEs_Pulse.hpp
+ * @brief Streaming pulse shape extraction for one detector layer
+ *
+ * Follows a pulse from the hit to the re-arm (the armed->disarmed
+ * excursion of the detector) and builds its SEEsPulse record
+ * incrementally: peak, integral above the pedestal, rise time and time
+ * over threshold. Integer only; one compare and one add per sample.
+ *
+ * The pedestal is the last sample before the hit, so slow baseline drift
+ * does not bias the integral.
+ *
+ * Pile-up: a second particle inside the excursion shows up as a slope
+ * reversal - a fall of at least the pile-up dip below the running peak,
+ * then a rise of the dip again. Each reversal counts one more peak.
+ */
+
+#ifndef SEES_PULSE_HPP
+#define SEES_PULSE_HPP
+
+#include <Arduino.h>
+#include "SEEs_Interface.hpp"
+
+class SEEs_Pulse {
+public:
+    SEEs_Pulse()
+        : _pedestal(0), _integral(0), _peak(0), _hitUs(0), _peakUs(0),
+          _dip(0), _turn(0), _falling(false), _peaks(0) {}
+
+    /**
+     * @brief Fall and rise (ADC counts) that separate two peaks; 0 disables
+     */
+    void setPileupDip(uint16_t dip) { _dip = dip; }
+
+    /**
+     * @brief Armed sample - remembered as the next pulse's pedestal
+     */
+    void idle(uint16_t adc) { _pedestal = adc; }
+
+    /**
+     * @brief Hit sample - starts the pulse
+     */
+    void start(uint32_t t_us, uint16_t adc) {
+        _hitUs = t_us;
+        _peakUs = t_us;
+        _peak = adc;
+        _integral = 0;
+        _turn = adc;
+        _falling = false;
+        _peaks = 1;
+        add(t_us, adc);
+    }
+
+    /**
+     * @brief Disarmed sample inside the pulse
+     */
+    void add(uint32_t t_us, uint16_t adc) {
+        if (adc > _peak) {
+            _peak = adc;
+            _peakUs = t_us;
+        }
+        if (adc > _pedestal) _integral += adc - _pedestal;
+
+        // _turn is the running maximum while rising, the minimum while falling
+        if (!_falling) {
+            if (adc > _turn) _turn = adc;
+            else if (_dip && adc + _dip <= _turn) { _falling = true; _turn = adc; }
+        } else {
+            if (adc < _turn) _turn = adc;
+            else if (adc >= _turn + _dip) {
+                _falling = false;
+                _turn = adc;
+                if (_peaks < 0xFF) _peaks++;
+            }
+        }
+    }
+
+    /**
+     * @brief Re-arm sample (not part of the pulse) - completes the record
+     *
+     * The record keeps this pulse's pedestal; the re-arm sample then
+     * becomes the pedestal of the next pulse, as an armed sample would.
+     *
+     * @param t_us Time of the re-arm sample
+     * @param adc The re-arm sample
+     * @param layer Layer index
+     * @param out Record, t_us in micros()
+     */
+    void finish(uint32_t t_us, uint16_t adc, uint8_t layer, SEEsPulse& out) {
+        out.t_us = _hitUs;
+        out.integral = _integral;
+        out.peak_adc = _peak;
+        out.pedestal_adc = _pedestal;
+        out.rise_us = saturate(_peakUs - _hitUs);
+        out.duration_us = saturate(t_us - _hitUs);
+        out.layer = layer;
+        out.peaks = _peaks;
+        _pedestal = adc;
+    }
+
+    uint16_t peak() const { return _peak; }
+    uint8_t peaks() const { return _peaks; }
+
+private:
+    uint16_t _pedestal;
+    uint32_t _integral;
+    uint16_t _peak;
+    uint32_t _hitUs;
+    uint32_t _peakUs;
+    uint16_t _dip;
+    uint32_t _turn;          // uint32: _turn + _dip must not wrap
+    bool _falling;
+    uint8_t _peaks;
+
+    static uint16_t saturate(uint32_t us) { return us > 0xFFFF ? 0xFFFF : (uint16_t)us; }
+};
+
+#endif // SEES_PULSE_HPP
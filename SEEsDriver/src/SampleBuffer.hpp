@@ -3,53 +3,154 @@
  * @brief RAM-based circular sample buffer for SEEs
  *
  * Stores ALL samples in Teensy 4.1's internal RAM using compact format.
- * No SD card required.
+ * No SD card required. Slot layout is in SampleStorage.hpp.
  *
- * Memory: 5 bytes/sample × 100,000 samples = 500 KB
+ * SampleBufferT is a template over sample rate, window and layout; every
+ * size is constexpr and checked against the RAM budget at compile time.
+ * SampleBuffer is the firmware's instance, configured by build flags:
+ *
+ *   SEES_SAMPLE_RATE_HZ  - samples per second (default 10000)
+ *   SEES_WINDOW_SECONDS  - rolling window (default 10 / SEES_CHANNELS; layouts may raise it)
+ *   SEES_BUFFER_SAMPLES  - capacity override (default rate × window)
+ *
+ * Multi-channel builds (SEES_CHANNELS) keep one SampleBuffer per channel;
+ * the default window shrinks so all of them fit the budget.
+ *
+ * Memory: 2.25 bytes/sample (SoA) × 100,000 samples + 16 KB corrections = 236 KB
  * Duration: 10 seconds at 10 kS/s
+ *
+ * A sparse time index (absolute timestamp of every TIME_INDEX_STRIDE-th
+ * sample) lets extract() find a time window in O(log n) plus at most one
+ * stride of deltas, without walking the whole ring.
+ *
+ * A hit index (sequence number and time of each hit, evicted along with
+ * the samples) makes hit lookups and counts cost O(hits), not O(samples).
  */
 
 #ifndef SAMPLE_BUFFER_HPP
 #define SAMPLE_BUFFER_HPP
 
 #include <Arduino.h>
+#include "SampleStorage.hpp"
+#include "SEEs_Interface.hpp"
+
+#ifndef SEES_SAMPLE_RATE_HZ
+#define SEES_SAMPLE_RATE_HZ 10000
+#endif
+
+#ifndef SEES_WINDOW_SECONDS
+#if defined(SEES_BUFFER_COMPRESSED)
+#define SEES_WINDOW_SECONDS (120 / SEES_CHANNELS)  // upper bound; the pool sets the real window
+#elif defined(SEES_BUFFER_TIERED)
+#define SEES_WINDOW_SECONDS (180 / SEES_CHANNELS)  // ~7.4 MB of the 8 MB PSRAM
+#elif defined(SEES_BUFFER_PACKED)
+#define SEES_WINDOW_SECONDS (20 / SEES_CHANNELS)   // ~360 KB
+#else
+#define SEES_WINDOW_SECONDS (10 / SEES_CHANNELS)
+#endif
+#endif
+
+// Ring capacity override, e.g. -DSEES_BUFFER_SAMPLES=65536. A power of two
+// turns ring wrap into a mask.
+#ifndef SEES_BUFFER_SAMPLES
+#define SEES_BUFFER_SAMPLES ((size_t)SEES_SAMPLE_RATE_HZ * SEES_WINDOW_SECONDS)
+#endif
+
+// Internal RAM available to the buffer: the 512 KB RAM2 heap, less DMAMEM
+// buffers (USB, DMA ping-pong)
+#ifndef SEES_RAM_BUDGET_BYTES
+#define SEES_RAM_BUDGET_BYTES (500UL * 1024UL)
+#endif
+
+// Hits remembered by the hit index (power of two, 8 bytes each). Beyond
+// this many hits in the window the oldest drop out of the index only.
+#ifndef SEES_HIT_INDEX_SIZE
+#define SEES_HIT_INDEX_SIZE 2048
+#endif
+
+// Sample gaps too long for a 16-bit time delta (65.5 ms, e.g. an SD or USB
+// stall) remembered at full length (power of two, 8 bytes each). Beyond this
+// many in the window the oldest read back as 65.5 ms and count as dropped
+// time corrections.
+#ifndef SEES_LONG_GAP_SLOTS
+#define SEES_LONG_GAP_SLOTS 64
+#endif
+
+// External PSRAM (one 8 MB chip on the Teensy 4.1)
+#ifndef SEES_PSRAM_BUDGET_BYTES
+#define SEES_PSRAM_BUDGET_BYTES (8UL * 1024UL * 1024UL)
+#endif
 
 /**
- * @brief Compact sample record - 5 bytes per sample
+ * @brief Snapshot output encoding
  *
- * Stores raw ADC value instead of float voltage.
- * Time is reconstructed from sample index and start time.
+ * Text:   [SNAP_START], CSV lines, [SNAP_END]
+ * Binary: SEES_FRAME_SNAP_HEADER, SEES_FRAME_SNAP_DATA..., SEES_FRAME_SNAP_END
+ *         (raw samples as SampleCodec blocks; the host rebuilds time/volts)
  */
-struct __attribute__((packed)) CompactSample {
-    uint16_t adc_raw;     // 2 bytes - raw 12-bit ADC value (0-4095)
-    uint16_t time_delta;  // 2 bytes - microseconds since last sample (0-65535)
-    uint8_t hit;          // 1 byte  - hit flag (0 or 1)
-};  // Total: 5 bytes, no padding due to __attribute__((packed))
+enum class SnapFormat : uint8_t { Text, Binary };
 
-class SampleBuffer {
-public:
-    static constexpr size_t BUFFER_SECONDS = 10;      // 10 second rolling buffer
-    static constexpr size_t SAMPLES_PER_SEC = 10000;  // 10 kS/s
-    static constexpr size_t TOTAL_SAMPLES = BUFFER_SECONDS * SAMPLES_PER_SEC;  // 100,000 samples
-    static constexpr size_t BUFFER_SIZE_BYTES = TOTAL_SAMPLES * sizeof(CompactSample);  // 500 KB
+static constexpr size_t sees_pow2_at_least(size_t n) {
+    return (n <= 1) ? 1 : 2 * sees_pow2_at_least((n + 1) / 2);
+}
 
-    SampleBuffer() : _buffer(nullptr), _head(0), _size(0), _lastTimeUs(0), _totalHits(0) {}
+template <uint32_t SampleRateHz, uint32_t WindowSeconds, typename Storage,
+          size_t Capacity = (size_t)SampleRateHz * WindowSeconds>
+class SampleBufferT {
+public:
+    static constexpr size_t BUFFER_SECONDS = WindowSeconds;
+    static constexpr size_t SAMPLES_PER_SEC = SampleRateHz;
+    static constexpr size_t TOTAL_SAMPLES = Capacity;
+    static constexpr size_t BUFFER_SIZE_BYTES = Storage::bytesFor(TOTAL_SAMPLES);
+    static constexpr size_t RAM_BYTES = Storage::ramBytesFor(TOTAL_SAMPLES);
+    static constexpr uint16_t NOMINAL_DELTA_US = 1000000UL / SAMPLES_PER_SEC;
+    static constexpr bool POW2_CAPACITY = (TOTAL_SAMPLES & (TOTAL_SAMPLES - 1)) == 0;
+
+    static_assert(SampleRateHz > 0 && 1000000UL % SampleRateHz == 0,
+                  "sample period must be a whole number of microseconds");
+    static_assert(1000000UL / SampleRateHz <= UINT16_MAX,
+                  "sample period must fit the 16-bit time deltas (rate >= 16 Hz)");
+    static_assert(TOTAL_SAMPLES > 0 && TOTAL_SAMPLES <= 0x7FFFFFFFUL,
+                  "capacity must fit the 32-bit sample sequence numbers");
+    static_assert(RAM_BYTES <= SEES_RAM_BUDGET_BYTES,
+                  "sample buffer exceeds the internal RAM budget - shorten the "
+                  "window, lower the rate or pick a denser layout");
+    static_assert(BUFFER_SIZE_BYTES - RAM_BYTES <= SEES_PSRAM_BUDGET_BYTES,
+                  "sample buffer exceeds the PSRAM budget");
+
+    static constexpr uint8_t ADC_BITS = 12;
+    static constexpr float ADC_VREF = 3.3f;
+    static constexpr size_t SNAP_BLOCK_BYTES = sees_block_max_bytes(SEES_SNAP_BLOCK_SAMPLES);
+    static_assert(sizeof(SEEsSnapData) + SNAP_BLOCK_BYTES <= SEES_FRAME_MAX_PAYLOAD,
+                  "snap data frame does not fit a frame payload");
+
+    // Time index: one checkpoint per stride, in a power-of-two ring so slot
+    // numbers stay consistent when the 32-bit sequence numbers wrap
+    static constexpr uint32_t TIME_INDEX_STRIDE = 1024;
+    static constexpr size_t TIME_INDEX_SLOTS = sees_pow2_at_least(TOTAL_SAMPLES / TIME_INDEX_STRIDE + 2);
+
+    static constexpr size_t HIT_INDEX_SIZE = SEES_HIT_INDEX_SIZE;
+    static_assert(HIT_INDEX_SIZE > 0 && (HIT_INDEX_SIZE & (HIT_INDEX_SIZE - 1)) == 0,
+                  "hit index size must be a power of two");
+
+    static constexpr size_t LONG_GAP_SLOTS = SEES_LONG_GAP_SLOTS;
+    static_assert(LONG_GAP_SLOTS > 0 && (LONG_GAP_SLOTS & (LONG_GAP_SLOTS - 1)) == 0,
+                  "long gap slots must be a power of two");
+
+    SampleBufferT()
+        : _head(0), _size(0), _written(0), _lastTimeUs(0), _totalHits(0), _firstHit(1),
+          _longGapCount(0), _longGapsDropped(0),
+          _snapActive(false), _snapNext(0), _snapEnd(0), _snapFirst(0),
+          _snapStartUs(0), _snapTimeUs(0), _snapHits(0), _snapLost(0),
+          _snapFormat(SnapFormat::Text), _snapId(0), _snapDataSeq(0) {}
 
-    ~SampleBuffer() {
-        if (_buffer) {
-            delete[] _buffer;
-            _buffer = nullptr;
-        }
-    }
 
     /**
      * @brief Initialize buffer - allocates RAM
      * @return true if allocation succeeded
      */
     bool begin() {
-        _buffer = new (std::nothrow) CompactSample[TOTAL_SAMPLES];
-
-        if (!_buffer) {
+        if (!_store.allocate(TOTAL_SAMPLES, NOMINAL_DELTA_US)) {
             Serial.println("[SampleBuffer] ERROR: Failed to allocate RAM");
             Serial.print("[SampleBuffer]   Requested: ");
             Serial.print(BUFFER_SIZE_BYTES / 1024);
@@ -59,103 +160,365 @@ public:
 
         _head = 0;
         _size = 0;
+        _written = 0;
         _lastTimeUs = micros();
         _totalHits = 0;
+        _firstHit = 1;
+        _longGapCount = 0;
+        _snapActive = false;
 
         Serial.println("[SampleBuffer] Initialized (RAM mode)");
         Serial.print("[SampleBuffer]   Capacity: ");
         Serial.print(TOTAL_SAMPLES);
         Serial.print(" samples (");
-        Serial.print(BUFFER_SECONDS);
+        Serial.print(TOTAL_SAMPLES / SAMPLES_PER_SEC);
         Serial.println(" seconds)");
         Serial.print("[SampleBuffer]   Memory: ");
         Serial.print(BUFFER_SIZE_BYTES / 1024);
-        Serial.println(" KB");
+        Serial.print(" KB (");
+        Serial.print(Storage::NAME);
+        Serial.println(")");
 
         return true;
     }
 
     /**
-     * @brief Record a sample
+     * @brief Record a sample taken now
      * @param adc_raw Raw ADC value (0-4095)
      * @param hit Whether this sample is a hit (0 or 1)
      */
     void record(uint16_t adc_raw, uint8_t hit) {
-        if (!_buffer) return;
+        record(adc_raw, hit, micros());
+    }
 
-        uint32_t nowUs = micros();
-        uint32_t delta = nowUs - _lastTimeUs;
-        _lastTimeUs = nowUs;
+    /**
+     * @brief Record a sample with its acquisition timestamp
+     * @param adc_raw Raw ADC value (0-4095)
+     * @param hit Whether this sample is a hit (0 or 1)
+     * @param nowUs micros() when the sample was taken
+     */
+    void record(uint16_t adc_raw, uint8_t hit, uint32_t nowUs) {
+        if (!_store.allocated()) return;
 
-        // Clamp delta to uint16_t max (65535 µs = 65.5 ms)
-        if (delta > 65535) delta = 65535;
+        if ((_written & (TIME_INDEX_STRIDE - 1)) == 0) {
+            _timeIndex[timeSlot(_written)] = nowUs;
+        }
 
-        _buffer[_head].adc_raw = adc_raw;
-        _buffer[_head].time_delta = (uint16_t)delta;
-        _buffer[_head].hit = hit;
+        uint16_t delta = markDelta(_written, nowUs - _lastTimeUs);
+        _lastTimeUs = nowUs;
+
+        _store.writeRun(_head, &adc_raw, &hit, 1, delta, delta);
 
-        if (hit) _totalHits++;
+        if (hit) indexHit(_written, nowUs);
 
-        _head = (_head + 1) % TOTAL_SAMPLES;
+        _head = wrap(_head + 1);
         if (_size < TOTAL_SAMPLES) _size++;
+        _written++;
+        evictHits();
+    }
+
+    /**
+     * @brief Record a block of evenly spaced samples
+     *
+     * Appends in at most two contiguous runs (before and after the ring
+     * wraps), with no per-sample clock reads or index wrapping.
+     *
+     * @param adc Raw ADC values (0-4095)
+     * @param hits Hit flags (0 or 1), one per sample
+     * @param n Number of samples
+     * @param t0 micros() time of adc[0]
+     * @param dt Spacing between samples in microseconds
+     */
+    void recordBlock(const uint16_t* adc, const uint8_t* hits, size_t n,
+                     uint32_t t0, uint32_t dt) {
+        if (!_store.allocated() || n == 0) return;
+
+        uint16_t firstDelta = markDelta(_written, t0 - _lastTimeUs);
+        _lastTimeUs = t0 + (uint32_t)(n - 1) * dt;
+
+        for (size_t i = 0; i < n; i++) {
+            if (hits[i]) indexHit(_written + (uint32_t)i, t0 + (uint32_t)i * dt);
+        }
+        for (uint32_t off = (0U - _written) & (TIME_INDEX_STRIDE - 1); off < n; off += TIME_INDEX_STRIDE) {
+            _timeIndex[timeSlot(_written + off)] = t0 + off * dt;
+        }
+        _written += (uint32_t)n;
+
+        // Only the newest TOTAL_SAMPLES of an oversized block survive
+        if (n > TOTAL_SAMPLES) {
+            size_t skip = n - TOTAL_SAMPLES;
+            adc += skip;
+            hits += skip;
+            n = TOTAL_SAMPLES;
+            firstDelta = clampDelta(dt);
+        }
+
+        size_t first = TOTAL_SAMPLES - _head;
+        if (first > n) first = n;
+
+        _store.writeRun(_head, adc, hits, first, firstDelta, clampDelta(dt));
+        if (n > first) {
+            _store.writeRun(0, adc + first, hits + first, n - first, clampDelta(dt), clampDelta(dt));
+        }
+
+        _head = wrap(_head + n);
+        _size = (_size + n < TOTAL_SAMPLES) ? _size + n : TOTAL_SAMPLES;
+        evictHits();
     }
 
     /**
-     * @brief Output snap data to Serial
+     * @brief Deferred storage work (tiered flush); call from loop()
+     */
+    void service() { _store.service(); }
+
+    /**
+     * @brief Writes that waited for deferred storage work done inline
+     *        (tiered: hot ring full because service() fell behind)
+     */
+    uint32_t storageStalls() const { return _store.stalls(); }
+
+    /**
+     * @brief Time deltas there was no room to keep: off-nominal deltas the
+     *        layout dropped (read back as the nominal period) and long gaps
+     *        pushed out of the long-gap table (read back as 65.5 ms)
+     */
+    uint32_t correctionsDropped() const { return _store.correctionsDropped() + _longGapsDropped; }
+
+    /**
+     * @brief Freeze the current contents as a snapshot and start output
      *
-     * Outputs all buffered samples as CSV, reconstructing timestamps.
+     * The snapshot covers every sample recorded so far. Recording continues
+     * while it drains; outputSnapChunk() must stay ahead of the writer,
+     * otherwise the overwritten samples are skipped and reported.
+     *
+     * @param format CSV lines or binary frames
+     * @param streamZeroUs micros() origin of stream timestamps (binary header)
+     * @return false if there is no data (nothing to drain)
      */
-    void outputSnap() {
-        if (!_buffer || _size == 0) {
+    bool beginSnap(SnapFormat format = SnapFormat::Text, uint32_t streamZeroUs = 0) {
+        if (!_store.allocated() || held() == 0) {
             Serial.println("[SampleBuffer] No data available");
-            return;
+            return false;
         }
 
-        Serial.println("[SNAP_START]");
-        Serial.println("time_ms,voltage_V,hit,total_hits");
+        startSnap(_written - (uint32_t)held(), _written, _lastTimeUs, format, streamZeroUs);
+        return true;
+    }
+
+    /**
+     * @brief Start a snapshot of the samples taken in [tStartUs, tEndUs]
+     *
+     * Same output and draining as beginSnap(), limited to the window. A
+     * window reaching past the newest sample ends at the newest sample.
+     *
+     * @param tStartUs micros() of the window start
+     * @param tEndUs micros() of the window end (inclusive)
+     * @return false if no retained sample falls in the window
+     */
+    bool extract(uint32_t tStartUs, uint32_t tEndUs,
+                 SnapFormat format = SnapFormat::Text, uint32_t streamZeroUs = 0) {
+        if (!_store.allocated() || held() == 0) {
+            Serial.println("[SampleBuffer] No data available");
+            return false;
+        }
+
+        uint32_t first = seqAtOrAfter(tStartUs);
+        uint32_t end = seqAtOrAfter(tEndUs + 1);
+        if (first == end) {
+            Serial.println("[SampleBuffer] No data in window");
+            return false;
+        }
+
+        startSnap(first, end, timeOf(end - 1), format, streamZeroUs);
+        return true;
+    }
+
+    /**
+     * @brief Start a snapshot of the window around a recorded hit
+     * @param hitIndex Hit number since begin()/clear(), 1 = first hit
+     * @param preUs Window start before the hit
+     * @param postUs Window end after the hit
+     * @return false if that hit is no longer (or not yet) in the buffer
+     */
+    bool extractAroundHit(uint32_t hitIndex, uint32_t preUs, uint32_t postUs,
+                          SnapFormat format = SnapFormat::Text, uint32_t streamZeroUs = 0) {
+        uint32_t t;
+        uint16_t adc;
+        if (!findHit(hitIndex, t, adc)) {
+            Serial.println("[SampleBuffer] Hit not in buffer");
+            return false;
+        }
+        return extract(t - preUs, t + postUs, format, streamZeroUs);
+    }
+
+    /**
+     * @brief Hit number of the oldest indexed hit (firstHit() + heldHits() - 1 is the newest)
+     */
+    uint32_t firstHit() const { return _firstHit; }
 
-        // Find start position (oldest sample)
-        size_t start = (_size < TOTAL_SAMPLES) ? 0 : _head;
+    /**
+     * @brief Hits still in the index (retained in the buffer)
+     */
+    size_t heldHits() const { return _totalHits + 1 - _firstHit; }
 
-        // Reconstruct timestamps from deltas
-        float time_ms = 0.0f;
-        uint32_t runningHits = 0;
+    /**
+     * @brief Look up a hit in O(1)
+     * @param hitIndex Hit number since begin()/clear(), 1 = first hit
+     * @param timeUs micros() of the hit sample
+     * @param adc Raw ADC value of the hit sample
+     * @return false if the hit has left the buffer (or index) or not happened yet
+     */
+    bool findHit(uint32_t hitIndex, uint32_t& timeUs, uint16_t& adc) const {
+        if ((int32_t)(hitIndex - _firstHit) < 0 || (int32_t)(hitIndex - _totalHits) > 0) {
+            return false;
+        }
+        const HitRecord& h = _hitIndex[hitSlot(hitIndex)];
+        timeUs = h.timeUs;
+        adc = _store.adc(indexOf(h.seq));
+        return true;
+    }
+
+    /**
+     * @brief Indexed hits taken in [tStartUs, tEndUs], in O(log hits)
+     */
+    uint32_t countHits(uint32_t tStartUs, uint32_t tEndUs) const {
+        return firstHitAtOrAfter(tEndUs + 1) - firstHitAtOrAfter(tStartUs);
+    }
+
+    /**
+     * @brief micros() of a retained sample
+     * @param seq Sample sequence number (samples recorded since begin()/clear())
+     *
+     * Walks the deltas from the nearest retained checkpoint (forward from
+     * the one at or before seq, else back from the next one or the newest
+     * sample).
+     */
+    uint32_t timeOf(uint32_t seq) const {
+        uint32_t oldest = _written - (uint32_t)held();
+        uint32_t base = seq & ~(TIME_INDEX_STRIDE - 1);
+
+        if ((int32_t)(base - oldest) >= 0) {
+            uint32_t t = _timeIndex[timeSlot(base)];
+            for (uint32_t s = base; s != seq; ) {
+                s++;
+                t += deltaOf(s);
+            }
+            return t;
+        }
 
-        for (size_t i = 0; i < _size; i++) {
-            size_t idx = (start + i) % TOTAL_SAMPLES;
-            CompactSample& s = _buffer[idx];
+        uint32_t anchor = base + TIME_INDEX_STRIDE;
+        uint32_t t;
+        if ((int32_t)(anchor - _written) < 0) {
+            t = _timeIndex[timeSlot(anchor)];
+        } else {
+            anchor = _written - 1;
+            t = _lastTimeUs;
+        }
+        for (uint32_t s = anchor; s != seq; s--) {
+            t -= deltaOf(s);
+        }
+        return t;
+    }
 
-            // Accumulate time from deltas
-            if (i > 0) {
-                time_ms += s.time_delta / 1000.0f;
+    /**
+     * @brief First retained sample taken at or after tUs (_written if none)
+     *
+     * Binary search over the retained checkpoints, then a walk of at most
+     * one stride. Times compare wrap-safe, so windows must stay under ~35 min.
+     */
+    uint32_t seqAtOrAfter(uint32_t tUs) const {
+        uint32_t oldest = _written - (uint32_t)held();
+        uint32_t firstCp = (oldest + TIME_INDEX_STRIDE - 1) & ~(TIME_INDEX_STRIDE - 1);
+
+        // Last checkpoint at or before tUs
+        uint32_t seq = oldest;
+        if ((int32_t)(_written - firstCp) > 0) {
+            uint32_t lo = 0;
+            uint32_t hi = (_written - firstCp - 1) / TIME_INDEX_STRIDE + 1;  // checkpoint count
+            while (lo < hi) {
+                uint32_t mid = lo + (hi - lo) / 2;
+                uint32_t cp = firstCp + mid * TIME_INDEX_STRIDE;
+                if ((int32_t)(_timeIndex[timeSlot(cp)] - tUs) <= 0) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
             }
+            if (lo > 0) seq = firstCp + (lo - 1) * TIME_INDEX_STRIDE;
+        }
 
-            // Convert ADC to voltage (3.3V reference, 12-bit ADC)
-            float voltage_V = (s.adc_raw / 4095.0f) * 3.3f;
+        uint32_t t = timeOf(seq);
+        while (seq != _written && (int32_t)(t - tUs) < 0) {
+            seq++;
+            if (seq != _written) t += deltaOf(seq);
+        }
+        return seq;
+    }
 
-            if (s.hit) runningHits++;
+    /**
+     * @brief Output at least maxSamples snapshot samples (fewer at the end)
+     *
+     * Text: one CSV line per sample, timestamps rebuilt from deltas starting
+     * at 0 for the oldest sample. Binary: one data frame per
+     * SEES_SNAP_BLOCK_SAMPLES samples.
+     *
+     * @return true when the snapshot is complete (or none is active)
+     */
+    bool outputSnapChunk(size_t maxSamples) {
+        if (!_snapActive) return true;
+
+        // Skip anything the writer has already overwritten
+        uint32_t oldest = _written - (uint32_t)held();
+        if ((int32_t)(_snapNext - oldest) < 0) {
+            _snapLost += oldest - _snapNext;
+            _snapNext = oldest;
+            _snapTimeUs = timeOf(oldest) - _snapStartUs;
+        }
 
-            // Output CSV line
-            Serial.print(time_ms, 3);
-            Serial.print(',');
-            Serial.print(voltage_V, 4);
-            Serial.print(',');
-            Serial.print(s.hit);
-            Serial.print(',');
-            Serial.println(runningHits);
+        size_t done = 0;
+        while (_snapNext != _snapEnd && done < maxSamples) {
+            done += (_snapFormat == SnapFormat::Binary) ? outputSnapBlock() : outputSnapLine();
         }
 
-        Serial.println("[SNAP_END]");
+        if (_snapNext != _snapEnd) return false;
+
+        _snapActive = false;
+        if (_snapFormat == SnapFormat::Binary) {
+            SEEsSnapEnd end;
+            end.snap_id = _snapId;
+            end.samples_sent = _snapEnd - _snapFirst - _snapLost;
+            end.samples_lost = _snapLost;
+            end.hits = _snapHits;
+            writeFrame(SEES_FRAME_SNAP_END, (uint16_t)_snapId, &end, sizeof(end));
+        } else {
+            Serial.println("[SNAP_END]");
+        }
 
         Serial.print("[SampleBuffer] Output ");
-        Serial.print(_size);
+        Serial.print(_snapEnd - _snapFirst - _snapLost);
         Serial.println(" samples");
+        if (_snapLost > 0) {
+            Serial.print("[SampleBuffer] WARNING: ");
+            Serial.print(_snapLost);
+            Serial.println(" samples overwritten before output");
+        }
+        return true;
     }
 
+    /**
+     * @brief Whether a snapshot is being drained
+     */
+    bool snapActive() const { return _snapActive; }
+
     /**
      * @brief Get current sample count
      */
-    size_t size() const { return _size; }
+    size_t size() const { return held(); }
+
+    /**
+     * @brief micros() of the newest recorded sample
+     */
+    uint32_t lastSampleUs() const { return _lastTimeUs; }
 
     /**
      * @brief Get total hits recorded
@@ -166,18 +529,281 @@ public:
      * @brief Clear the buffer
      */
     void clear() {
+        _store.reset();
         _head = 0;
         _size = 0;
+        _written = 0;
         _totalHits = 0;
+        _firstHit = 1;
+        _longGapCount = 0;
         _lastTimeUs = micros();
+        _snapActive = false;
     }
 
 private:
-    CompactSample* _buffer;
+    Storage _store;
     size_t _head;
     size_t _size;
+    uint32_t _written;      // Samples recorded since begin() (sequence number of next sample)
     uint32_t _lastTimeUs;
     uint32_t _totalHits;
+
+    // Hit index: hit number h lives in slot hitSlot(h); _firstHit is the
+    // oldest still retained (_totalHits + 1 when empty)
+    struct HitRecord {
+        uint32_t seq;
+        uint32_t timeUs;
+    };
+    HitRecord _hitIndex[HIT_INDEX_SIZE];
+    uint32_t _firstHit;
+
+    // Long gaps: the full delta of each sample stored with a saturated
+    // (UINT16_MAX) one, newest in slot (_longGapCount - 1) & (LONG_GAP_SLOTS - 1)
+    struct LongGap {
+        uint32_t seq;
+        uint32_t deltaUs;
+    };
+    LongGap _longGaps[LONG_GAP_SLOTS];
+    uint32_t _longGapCount;     // recorded since begin()/clear()
+    uint32_t _longGapsDropped;  // overwritten while their sample was still retained
+
+    // Snapshot drain state (sequence numbers)
+    bool _snapActive;
+    uint32_t _snapNext;
+    uint32_t _snapEnd;
+    uint32_t _snapFirst;
+    uint32_t _snapStartUs;  // micros() of the snapshot's first sample
+    uint32_t _snapTimeUs;   // time of sample _snapNext from the first one
+    uint32_t _snapHits;
+    uint32_t _snapLost;
+    SnapFormat _snapFormat;
+    uint32_t _snapId;
+    uint16_t _snapDataSeq;
+
+    // Absolute micros() of every TIME_INDEX_STRIDE-th sample, by timeSlot()
+    uint32_t _timeIndex[TIME_INDEX_SLOTS];
+
+    // Binary snap scratch: one block of samples, its payload and frame
+    uint16_t _snapAdc[SEES_SNAP_BLOCK_SAMPLES];
+    uint8_t _snapHitFlags[SEES_SNAP_BLOCK_SAMPLES];
+    uint16_t _snapDeltas[SEES_SNAP_BLOCK_SAMPLES];
+    uint8_t _snapPayload[sizeof(SEEsSnapData) + SNAP_BLOCK_BYTES];
+    uint8_t _snapFrame[SEES_FRAME_OVERHEAD + sizeof(_snapPayload)];
+
+    /**
+     * @brief Freeze sequence numbers [first, end) as the snapshot and start output
+     */
+    void startSnap(uint32_t first, uint32_t end, uint32_t endTimeUs,
+                   SnapFormat format, uint32_t streamZeroUs) {
+        _snapFirst = first;
+        _snapNext = first;
+        _snapEnd = end;
+        _snapStartUs = timeOf(first);
+        _snapTimeUs = 0;
+        _snapHits = 0;
+        _snapLost = 0;
+        _snapFormat = format;
+        _snapId++;
+        _snapActive = true;
+
+        if (format == SnapFormat::Binary) {
+            SEEsSnapHeader hdr;
+            hdr.snap_id = _snapId;
+            hdr.sample_count = end - first;
+            hdr.end_us = endTimeUs - streamZeroUs;
+            hdr.dt_us = NOMINAL_DELTA_US;
+            hdr.adc_bits = ADC_BITS;
+            hdr.reserved = 0;
+            hdr.adc_vref = ADC_VREF;
+            writeFrame(SEES_FRAME_SNAP_HEADER, (uint16_t)_snapId, &hdr, sizeof(hdr));
+            return;
+        }
+
+        Serial.println("[SNAP_START]");
+        Serial.println("time_ms,voltage_V,hit,total_hits");
+    }
+
+    void indexHit(uint32_t seq, uint32_t timeUs) {
+        _totalHits++;
+        _hitIndex[hitSlot(_totalHits)] = {seq, timeUs};
+        if (_totalHits - _firstHit >= HIT_INDEX_SIZE) _firstHit++;
+    }
+
+    /**
+     * @brief Drop index entries whose samples have been overwritten
+     */
+    void evictHits() {
+        uint32_t oldest = _written - (uint32_t)held();
+        while (_firstHit != _totalHits + 1 &&
+               (int32_t)(_hitIndex[hitSlot(_firstHit)].seq - oldest) < 0) {
+            _firstHit++;
+        }
+    }
+
+    /**
+     * @brief Number of the first indexed hit at or after tUs (_totalHits + 1 if none)
+     */
+    uint32_t firstHitAtOrAfter(uint32_t tUs) const {
+        uint32_t lo = _firstHit;
+        uint32_t hi = _totalHits + 1;
+        while (lo != hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if ((int32_t)(_hitIndex[hitSlot(mid)].timeUs - tUs) < 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    static size_t hitSlot(uint32_t hitIndex) {
+        return (hitIndex - 1) & (HIT_INDEX_SIZE - 1);
+    }
+
+    static size_t timeSlot(uint32_t seq) {
+        return (seq / TIME_INDEX_STRIDE) & (TIME_INDEX_SLOTS - 1);
+    }
+
+    /**
+     * @brief Output the next snapshot sample as a CSV line
+     */
+    size_t outputSnapLine() {
+        size_t idx = indexOf(_snapNext);
+        uint8_t hit = _store.hit(idx);
+
+        // Convert ADC to voltage (3.3V reference, 12-bit ADC)
+        float voltage_V = (_store.adc(idx) / 4095.0f) * ADC_VREF;
+
+        if (hit) _snapHits++;
+
+        // Output CSV line
+        Serial.print(_snapTimeUs / 1000.0f, 3);
+        Serial.print(',');
+        Serial.print(voltage_V, 4);
+        Serial.print(',');
+        Serial.print(hit);
+        Serial.print(',');
+        Serial.println(_snapHits);
+
+        uint32_t delta;
+        advanceSnap(delta);
+        return 1;
+    }
+
+    /**
+     * @brief Output the next snapshot samples as one binary data frame
+     */
+    size_t outputSnapBlock() {
+        SEEsSnapData data;
+        data.snap_id = _snapId;
+        data.first_index = _snapNext - _snapFirst;
+        data.first_us = _snapTimeUs;
+
+        // A gap too long for the 16-bit deltas starts the next block, whose
+        // first_us carries it in full
+        size_t n = 0;
+        uint32_t delta = 0;
+        do {
+            size_t idx = indexOf(_snapNext);
+            _snapAdc[n] = _store.adc(idx);
+            _snapHitFlags[n] = _store.hit(idx);
+            _snapDeltas[n] = (uint16_t)delta;
+            _snapHits += _snapHitFlags[n];
+            n++;
+        } while (advanceSnap(delta) && n < SEES_SNAP_BLOCK_SAMPLES && delta < UINT16_MAX);
+
+        memcpy(_snapPayload, &data, sizeof(data));
+        size_t len = sees_block_encode(_snapAdc, _snapHitFlags, _snapDeltas, n, NOMINAL_DELTA_US,
+                                       _snapPayload + sizeof(data), SNAP_BLOCK_BYTES);
+        writeFrame(SEES_FRAME_SNAP_DATA, _snapDataSeq++, _snapPayload, sizeof(data) + len);
+        return n;
+    }
+
+    void writeFrame(uint8_t type, uint16_t seq, const void* payload, size_t len) {
+        size_t n = sees_frame_encode(type, seq, payload, (uint16_t)len,
+                                     _snapFrame, sizeof(_snapFrame));
+        Serial.write(_snapFrame, n);
+    }
+
+    /**
+     * @brief Wrap an index in [0, 2 * TOTAL_SAMPLES) onto the ring
+     */
+    static size_t wrap(size_t i) {
+        if (POW2_CAPACITY) return i & (TOTAL_SAMPLES - 1);
+        return (i >= TOTAL_SAMPLES) ? i - TOTAL_SAMPLES : i;
+    }
+
+    /**
+     * @brief Samples still readable (the layout may evict before the ring wraps)
+     */
+    size_t held() const {
+        size_t retained = _store.retained();
+        return retained < _size ? retained : _size;
+    }
+
+    /**
+     * @brief Ring index of a retained sample sequence number
+     */
+    size_t indexOf(uint32_t seq) const {
+        size_t back = _written - seq;
+        return wrap(_head + TOTAL_SAMPLES - back);
+    }
+
+    static uint16_t clampDelta(uint32_t delta) {
+        // Clamp delta to uint16_t max (65535 µs = 65.5 ms)
+        return delta > 65535 ? 65535 : (uint16_t)delta;
+    }
+
+    /**
+     * @brief Delta to store for sample seq; a gap the 16 bits cannot hold
+     *        is stored saturated and kept in full as a long-gap marker
+     */
+    uint16_t markDelta(uint32_t seq, uint32_t deltaUs) {
+        if (deltaUs < UINT16_MAX) return (uint16_t)deltaUs;
+
+        LongGap& g = _longGaps[_longGapCount & (LONG_GAP_SLOTS - 1)];
+        uint32_t oldest = _written - (uint32_t)held();
+        if (_longGapCount >= LONG_GAP_SLOTS && (int32_t)(g.seq - oldest) >= 0) {
+            _longGapsDropped++;
+        }
+        g.seq = seq;
+        g.deltaUs = deltaUs;
+        _longGapCount++;
+        return UINT16_MAX;
+    }
+
+    /**
+     * @brief Time from the previous sample to retained sample seq, in µs
+     */
+    uint32_t deltaOf(uint32_t seq) const {
+        uint16_t d = _store.timeDelta(indexOf(seq));
+        if (d != UINT16_MAX) return d;
+
+        // Newest first: a marker for seq is almost always recent
+        size_t n = _longGapCount < LONG_GAP_SLOTS ? _longGapCount : LONG_GAP_SLOTS;
+        for (size_t i = 1; i <= n; i++) {
+            const LongGap& g = _longGaps[(_longGapCount - i) & (LONG_GAP_SLOTS - 1)];
+            if (g.seq == seq) return g.deltaUs;
+        }
+        return d;
+    }
+
+    /**
+     * @brief Step the snapshot to its next sample
+     * @param delta Set to that sample's time delta
+     * @return false at the end of the snapshot
+     */
+    bool advanceSnap(uint32_t& delta) {
+        _snapNext++;
+        if (_snapNext == _snapEnd) return false;
+        delta = deltaOf(_snapNext);
+        _snapTimeUs += delta;
+        return true;
+    }
 };
 
+using SampleBuffer = SampleBufferT<SEES_SAMPLE_RATE_HZ, SEES_WINDOW_SECONDS, SampleStorage,
+                                   SEES_BUFFER_SAMPLES>;
+
 #endif // SAMPLE_BUFFER_HPP
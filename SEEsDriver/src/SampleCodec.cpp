@@ -0,0 +1,139 @@
+#include "SampleCodec.hpp"
+#include <cstring>
+
+static inline uint16_t zigzag(int32_t v)   { return (uint16_t)(((uint32_t)v << 1) ^ (uint32_t)(v >> 31)); }
+static inline int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+static inline void put16(uint8_t *p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static inline uint16_t get16(const uint8_t *p) { return p[0] | ((uint16_t)p[1] << 8); }
+
+// -------------------------
+// Encoder
+// -------------------------
+size_t sees_block_encode(const uint16_t *adc, const uint8_t *hits, const uint16_t *deltas,
+                         size_t n, uint16_t nominalDt, uint8_t *out, size_t out_cap) {
+    if (n == 0 || n > SEES_BLOCK_MAX_SAMPLES) return 0;
+
+    size_t hitCount = 0, corrCount = 0;
+    uint16_t maxZz = 0;
+    for (size_t i = 0; i < n; i++) {
+        hitCount += hits[i] ? 1 : 0;
+        corrCount += (deltas[i] != nominalDt) ? 1 : 0;
+        if (i > 0) {
+            uint16_t zz = zigzag((int32_t)(adc[i] & 0x0FFF) - (int32_t)(adc[i - 1] & 0x0FFF));
+            if (zz > maxZz) maxZz = zz;
+        }
+    }
+
+    uint8_t width = 0;
+    while (width < 16 && (maxZz >> width)) width++;
+
+    bool hitBitset = hitCount > SEES_BLOCK_MAX_HIT_LIST;
+    size_t total = SEES_BLOCK_HEADER_BYTES +
+                   (hitBitset ? SEES_BLOCK_MAX_SAMPLES / 8 : hitCount) +
+                   corrCount * 3 + ((n - 1) * width + 7) / 8;
+    if (total > out_cap) return 0;
+
+    uint8_t *p = out;
+    *p++ = (uint8_t)(n - 1);
+    *p++ = width;
+    *p++ = hitBitset ? SEES_BLOCK_HIT_BITSET : (uint8_t)hitCount;
+    *p++ = 0;
+    put16(p, adc[0] & 0x0FFF); p += 2;
+    put16(p, nominalDt);       p += 2;
+    put16(p, (uint16_t)corrCount); p += 2;
+
+    if (hitBitset) {
+        memset(p, 0, SEES_BLOCK_MAX_SAMPLES / 8);
+        for (size_t i = 0; i < n; i++) {
+            if (hits[i]) p[i >> 3] |= 1 << (i & 7);
+        }
+        p += SEES_BLOCK_MAX_SAMPLES / 8;
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            if (hits[i]) *p++ = (uint8_t)i;
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        if (deltas[i] == nominalDt) continue;
+        *p++ = (uint8_t)i;
+        put16(p, deltas[i]); p += 2;
+    }
+
+    // Bit-pack ADC deltas, LSB first
+    uint32_t acc = 0;
+    uint8_t bits = 0;
+    for (size_t i = 1; i < n && width > 0; i++) {
+        acc |= (uint32_t)zigzag((int32_t)(adc[i] & 0x0FFF) - (int32_t)(adc[i - 1] & 0x0FFF)) << bits;
+        bits += width;
+        while (bits >= 8) {
+            *p++ = acc & 0xFF;
+            acc >>= 8;
+            bits -= 8;
+        }
+    }
+    if (bits > 0) *p++ = acc & 0xFF;
+
+    return (size_t)(p - out);
+}
+
+// -------------------------
+// Decoder
+// -------------------------
+size_t sees_block_decode(const uint8_t *in, size_t len,
+                         uint16_t *adc, uint8_t *hits, uint16_t *deltas) {
+    if (len < SEES_BLOCK_HEADER_BYTES) return 0;
+
+    size_t n = (size_t)in[0] + 1;
+    uint8_t width = in[1];
+    uint8_t hitCount = in[2];
+    uint16_t nominalDt = get16(in + 6);
+    size_t corrCount = get16(in + 8);
+
+    bool hitBitset = hitCount == SEES_BLOCK_HIT_BITSET;
+    size_t need = SEES_BLOCK_HEADER_BYTES +
+                  (hitBitset ? SEES_BLOCK_MAX_SAMPLES / 8 : hitCount) +
+                  corrCount * 3 + ((n - 1) * width + 7) / 8;
+    if (width > 13 || corrCount > n || need > len) return 0;
+
+    const uint8_t *p = in + SEES_BLOCK_HEADER_BYTES;
+
+    memset(hits, 0, n);
+    if (hitBitset) {
+        for (size_t i = 0; i < n; i++) hits[i] = (p[i >> 3] >> (i & 7)) & 1;
+        p += SEES_BLOCK_MAX_SAMPLES / 8;
+    } else {
+        for (size_t k = 0; k < hitCount; k++, p++) {
+            if (*p < n) hits[*p] = 1;
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) deltas[i] = nominalDt;
+    for (size_t k = 0; k < corrCount; k++, p += 3) {
+        if (p[0] < n) deltas[p[0]] = get16(p + 1);
+    }
+
+    int32_t value = get16(in + 4);
+    adc[0] = (uint16_t)value;
+
+    uint32_t acc = 0;
+    uint8_t bits = 0;
+    uint32_t mask = (1UL << width) - 1;
+    for (size_t i = 1; i < n; i++) {
+        while (bits < width) {
+            acc |= (uint32_t)(*p++) << bits;
+            bits += 8;
+        }
+        value += unzigzag(acc & mask);
+        acc >>= width;
+        bits -= width;
+        adc[i] = (uint16_t)(value & 0x0FFF);
+    }
+
+    return n;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file SampleCodec.hpp
+ * @brief Lossless block codec for recorded samples
+ *
+ * A block holds up to SEES_BLOCK_MAX_SAMPLES consecutive samples.
+ * Byte layout (little-endian):
+ *
+ *   u8  count - 1
+ *   u8  width          bits per packed ADC delta (0..13)
+ *   u8  hit_count      0xFF = 32-byte hit bitset follows instead of positions
+ *   u8  reserved
+ *   u16 adc0           first ADC value
+ *   u16 nominal_dt     time delta (µs) of every sample without a correction
+ *   u16 corr_count
+ *   u8  hits[hit_count]                   sample positions with hit = 1
+ *   (u8 pos, u16 dt)[corr_count]          samples whose delta != nominal_dt
+ *   bits[(count - 1) * width]             zigzag(adc[i] - adc[i-1]), LSB first
+ *
+ * The delta of sample 0 is relative to the last sample of the previous
+ * block, so a sequence of blocks decodes to exactly the recorded stream.
+ * scripts/sees_frames.py has the matching host decoder.
+ */
+
+#ifndef SAMPLE_CODEC_HPP
+#define SAMPLE_CODEC_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+static constexpr size_t SEES_BLOCK_MAX_SAMPLES = 256;
+static constexpr size_t SEES_BLOCK_HEADER_BYTES = 10;
+static constexpr uint8_t SEES_BLOCK_HIT_BITSET = 0xFF;
+static constexpr size_t SEES_BLOCK_MAX_HIT_LIST = 32;  // beyond this the bitset is smaller
+
+// Worst case for n samples: bitset hits, every delta corrected, 13-bit ADC deltas
+static constexpr size_t sees_block_max_bytes(size_t n) {
+    return SEES_BLOCK_HEADER_BYTES + SEES_BLOCK_MAX_SAMPLES / 8 + n * 3 + ((n - 1) * 13 + 7) / 8;
+}
+
+static constexpr size_t SEES_BLOCK_MAX_BYTES = sees_block_max_bytes(SEES_BLOCK_MAX_SAMPLES);
+
+/**
+ * @brief Encode n samples into out
+ * @param adc Raw 12-bit ADC values
+ * @param hits Hit flags (0 or 1)
+ * @param deltas Time since the previous sample (µs)
+ * @param n Sample count (1..SEES_BLOCK_MAX_SAMPLES)
+ * @param nominalDt Delta stored implicitly
+ * @return Encoded size, or 0 if n is out of range or out_cap is too small
+ */
+size_t sees_block_encode(const uint16_t *adc, const uint8_t *hits, const uint16_t *deltas,
+                         size_t n, uint16_t nominalDt, uint8_t *out, size_t out_cap);
+
+/**
+ * @brief Decode one block (outputs must hold SEES_BLOCK_MAX_SAMPLES)
+ * @return Sample count, or 0 if the block is malformed
+ */
+size_t sees_block_decode(const uint8_t *in, size_t len,
+                         uint16_t *adc, uint8_t *hits, uint16_t *deltas);
+
+#endif // SAMPLE_CODEC_HPP
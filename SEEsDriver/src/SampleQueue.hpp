@@ -0,0 +1,72 @@
+/**
+ * @file SampleQueue.hpp
+ * @brief Lock-free single-producer/single-consumer queue
+ *
+ * Producer is the acquisition ISR (or timer thread in the native build),
+ * consumer is loop(). Head and tail are free-running counters, so the
+ * queue holds exactly N entries and the slot index is a mask.
+ */
+
+#ifndef SAMPLE_QUEUE_HPP
+#define SAMPLE_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+template <typename T, size_t N>
+class SampleQueue {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "SampleQueue depth must be a power of two");
+
+public:
+    static constexpr size_t CAPACITY = N;
+
+    SampleQueue() : _head(0), _tail(0) {}
+
+    /**
+     * @brief Push one entry (producer side)
+     * @return false if the queue is full (entry dropped)
+     */
+    bool push(const T& item) {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) >= N) return false;
+
+        _items[head & (N - 1)] = item;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Pop one entry (consumer side)
+     * @return false if the queue is empty
+     */
+    bool pop(T& item) {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) return false;
+
+        item = _items[tail & (N - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Entries waiting (approximate while the producer runs)
+     */
+    size_t size() const {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Drop all entries (consumer side)
+     */
+    void clear() {
+        _tail.store(_head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    T _items[N];
+    std::atomic<uint32_t> _head;
+    std::atomic<uint32_t> _tail;
+};
+
+#endif // SAMPLE_QUEUE_HPP
@@ -0,0 +1,877 @@
+/**
+ * @file SampleStorage.hpp
+ * @brief Slot storage layouts for SampleBuffer
+ *
+ * SampleBuffer owns the ring bookkeeping (head, size, sequence numbers);
+ * a storage layout only maps slot index -> (adc_raw, time_delta, hit).
+ *
+ * Layout interface:
+ *   NAME                       - printed at startup
+ *   bytesFor(capacity)         - memory needed for capacity slots
+ *   ramBytesFor(capacity)      - the part of that in internal RAM
+ *   allocate(capacity, nominalDelta) / release() / allocated()
+ *   reset()                    - forget contents (ring restarts at slot 0)
+ *   writeRun(index, adc, hits, n, firstDelta, delta)
+ *                              - fill n contiguous slots (no wrap); slots
+ *                                are always written in ring order
+ *   adc(index), timeDelta(index), hit(index)
+ *   retained()                 - newest slots still readable (capacity unless
+ *                                the layout evicts early)
+ *   service()                  - deferred work, called from loop() between blocks
+ *   stalls()                   - writes that had to do deferred work inline
+ *                                because service() fell behind (0 if none)
+ *   correctionsDropped()       - off-nominal time deltas forgotten for lack
+ *                                of room; those slots read back as the
+ *                                nominal period (0 if none)
+ *
+ * Build flags:
+ *   SEES_BUFFER_AOS        - packed 5-byte CompactSample records (original layout)
+ *   SEES_BUFFER_PACKED     - 12-bit packed ADC + implied timing (1.75 B/sample)
+ *   SEES_BUFFER_COMPRESSED - lossless compressed blocks in a fixed byte pool
+ *   SEES_BUFFER_TIERED     - small RAM hot ring flushed to SoA arrays in PSRAM
+ *   (default)              - structure-of-arrays + implied timing (2.25 B/sample)
+ */
+
+#ifndef SAMPLE_STORAGE_HPP
+#define SAMPLE_STORAGE_HPP
+
+#include <Arduino.h>
+#include "SampleCodec.hpp"
+#include "SEEs_Channels.hpp"
+
+/**
+ * @brief Compact sample record - 5 bytes per sample
+ *
+ * Stores raw ADC value instead of float voltage.
+ * Time is reconstructed from sample index and start time.
+ */
+struct __attribute__((packed)) CompactSample {
+    uint16_t adc_raw;     // 2 bytes - raw 12-bit ADC value (0-4095)
+    uint16_t time_delta;  // 2 bytes - microseconds since last sample (0-65535)
+    uint8_t hit;          // 1 byte  - hit flag (0 or 1)
+};  // Total: 5 bytes, no padding due to __attribute__((packed))
+
+/**
+ * @brief Array-of-structures layout (CompactSample per slot)
+ *
+ * Every field access is unaligned; kept for comparison and fallback.
+ */
+class AosStorage {
+public:
+    static constexpr const char* NAME = "AoS 5 B/sample";
+
+    static constexpr size_t bytesFor(size_t capacity) {
+        return capacity * sizeof(CompactSample);
+    }
+
+    static constexpr size_t ramBytesFor(size_t capacity) { return bytesFor(capacity); }
+
+    AosStorage() : _samples(nullptr), _capacity(0) {}
+    ~AosStorage() { release(); }
+
+    bool allocate(size_t capacity, uint16_t /*nominalDelta*/) {
+        release();
+        _samples = new (std::nothrow) CompactSample[capacity];
+        _capacity = capacity;
+        return _samples != nullptr;
+    }
+
+    void release() {
+        delete[] _samples;
+        _samples = nullptr;
+    }
+
+    bool allocated() const { return _samples != nullptr; }
+    void reset() {}
+    size_t retained() const { return _capacity; }
+    void service() {}
+    uint32_t stalls() const { return 0; }
+    uint32_t correctionsDropped() const { return 0; }
+
+    void writeRun(size_t index, const uint16_t* adc, const uint8_t* hits, size_t n,
+                  uint16_t firstDelta, uint16_t delta) {
+        CompactSample* out = _samples + index;
+        for (size_t i = 0; i < n; i++) {
+            out[i].adc_raw = adc[i];
+            out[i].time_delta = delta;
+            out[i].hit = hits[i];
+        }
+        out[0].time_delta = firstDelta;
+    }
+
+    uint16_t adc(size_t index) const { return _samples[index].adc_raw; }
+    uint16_t timeDelta(size_t index) const { return _samples[index].time_delta; }
+    uint8_t hit(size_t index) const { return _samples[index].hit; }
+
+private:
+    CompactSample* _samples;
+    size_t _capacity;
+};
+
+static inline uint8_t sees_test_bit(const uint32_t* bits, size_t i) {
+    return (bits[i >> 5] >> (i & 31)) & 1;
+}
+
+static inline void sees_set_bit(uint32_t* bits, size_t i, uint8_t v) {
+    uint32_t mask = 1UL << (i & 31);
+    if (v) bits[i >> 5] |= mask;
+    else   bits[i >> 5] &= ~mask;
+}
+
+/**
+ * @brief Slot time deltas as the nominal period plus sparse corrections
+ *
+ * Nearly every delta is the nominal sample period. The rare slots that
+ * differ (gaps, the first sample of a block after a stall) are kept in a
+ * FIFO of corrections, flagged by a bitset. Because slots are written in
+ * ring order, the FIFO stays in slot order and is evicted in step with
+ * the ring; a lookup is a bit test, and a binary search for the flagged
+ * slots.
+ *
+ * 0.125 B/sample plus a fixed correction table.
+ */
+class SparseDeltas {
+public:
+    static constexpr size_t MAX_CORRECTIONS = 2048;
+
+    struct Correction {
+        uint32_t slot;
+        uint16_t delta;
+    };
+
+    static constexpr size_t bitsetWords(size_t capacity) { return (capacity + 31) / 32; }
+
+    static constexpr size_t bytesFor(size_t capacity) {
+        return bitsetWords(capacity) * sizeof(uint32_t) + MAX_CORRECTIONS * sizeof(Correction);
+    }
+
+    SparseDeltas()
+        : _corrected(nullptr), _corrections(nullptr), _capacity(0), _nominal(0),
+          _corrHead(0), _corrCount(0), _corrDropped(0) {}
+    ~SparseDeltas() { release(); }
+
+    bool allocate(size_t capacity, uint16_t nominalDelta) {
+        release();
+        _corrected = new (std::nothrow) uint32_t[bitsetWords(capacity)];
+        _corrections = new (std::nothrow) Correction[MAX_CORRECTIONS];
+        if (!_corrected || !_corrections) {
+            release();
+            return false;
+        }
+        _capacity = capacity;
+        _nominal = nominalDelta;
+        reset();
+        return true;
+    }
+
+    void release() {
+        delete[] _corrected;
+        delete[] _corrections;
+        _corrected = nullptr;
+        _corrections = nullptr;
+    }
+
+    void reset() {
+        memset(_corrected, 0, bitsetWords(_capacity) * sizeof(uint32_t));
+        _corrHead = 0;
+        _corrCount = 0;
+    }
+
+    /**
+     * @brief Deltas of n contiguous slots being overwritten (no wrap)
+     */
+    void writeRun(size_t index, size_t n, uint16_t firstDelta, uint16_t delta) {
+        // The overwritten slots' corrections are the oldest ones
+        while (_corrCount > 0 && _corrections[_corrHead].slot >= index &&
+               _corrections[_corrHead].slot < index + n) {
+            popCorrection();
+        }
+
+        if (firstDelta != _nominal) pushCorrection(index, firstDelta);
+        if (delta != _nominal) {
+            for (size_t i = 1; i < n; i++) pushCorrection(index + i, delta);
+        }
+    }
+
+    uint16_t at(size_t index) const {
+        if (!sees_test_bit(_corrected, index)) return _nominal;
+        return findCorrection(index);
+    }
+
+    /**
+     * @brief Corrections discarded because the table was full
+     */
+    uint32_t dropped() const { return _corrDropped; }
+
+private:
+    uint32_t* _corrected;
+    Correction* _corrections;
+    size_t _capacity;
+    uint16_t _nominal;
+    size_t _corrHead;
+    size_t _corrCount;
+    uint32_t _corrDropped;
+
+    const Correction& correctionAt(size_t i) const {
+        size_t k = _corrHead + i;
+        return _corrections[k >= MAX_CORRECTIONS ? k - MAX_CORRECTIONS : k];
+    }
+
+    void popCorrection() {
+        sees_set_bit(_corrected, _corrections[_corrHead].slot, 0);
+        _corrHead = (_corrHead + 1 == MAX_CORRECTIONS) ? 0 : _corrHead + 1;
+        _corrCount--;
+    }
+
+    void pushCorrection(size_t slot, uint16_t delta) {
+        if (_corrCount == MAX_CORRECTIONS) {
+            popCorrection();  // Oldest slot falls back to the nominal period
+            _corrDropped++;
+        }
+        size_t k = _corrHead + _corrCount;
+        Correction& c = _corrections[k >= MAX_CORRECTIONS ? k - MAX_CORRECTIONS : k];
+        c.slot = (uint32_t)slot;
+        c.delta = delta;
+        _corrCount++;
+        sees_set_bit(_corrected, slot, 1);
+    }
+
+    /**
+     * @brief Binary search the FIFO (slot order, rotated at the oldest entry)
+     */
+    uint16_t findCorrection(size_t slot) const {
+        size_t base = correctionAt(0).slot;
+        auto key = [&](size_t s) { return s >= base ? s - base : s + _capacity - base; };
+
+        size_t target = key(slot);
+        size_t lo = 0, hi = _corrCount;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (key(correctionAt(mid).slot) < target) lo = mid + 1;
+            else hi = mid;
+        }
+        if (lo < _corrCount && correctionAt(lo).slot == slot) return correctionAt(lo).delta;
+        return _nominal;
+    }
+};
+
+/**
+ * @brief Structure-of-arrays layout
+ *
+ * ADC values live in an aligned uint16_t array and hit flags in a
+ * 1-bit-per-sample bitset. Time deltas are implied to be the nominal
+ * period, with the rare exceptions in SparseDeltas (2.25 B/sample plus
+ * the correction table). A run of ADC values is a straight memcpy, and
+ * scans over one field touch only that field's cache lines.
+ */
+class SoaStorage {
+public:
+    static constexpr const char* NAME = "SoA 2.25 B/sample";
+
+    static constexpr size_t bitsetWords(size_t capacity) { return (capacity + 31) / 32; }
+
+    static constexpr size_t bytesFor(size_t capacity) {
+        return capacity * sizeof(uint16_t) + bitsetWords(capacity) * sizeof(uint32_t) +
+               SparseDeltas::bytesFor(capacity);
+    }
+
+    static constexpr size_t ramBytesFor(size_t capacity) { return bytesFor(capacity); }
+
+    SoaStorage() : _adc(nullptr), _hits(nullptr), _capacity(0) {}
+    ~SoaStorage() { release(); }
+
+    bool allocate(size_t capacity, uint16_t nominalDelta) {
+        release();
+        _adc = new (std::nothrow) uint16_t[capacity];
+        _hits = new (std::nothrow) uint32_t[bitsetWords(capacity)];
+        if (!_adc || !_hits || !_dt.allocate(capacity, nominalDelta)) {
+            release();
+            return false;
+        }
+        memset(_hits, 0, bitsetWords(capacity) * sizeof(uint32_t));
+        _capacity = capacity;
+        return true;
+    }
+
+    void release() {
+        delete[] _adc;
+        delete[] _hits;
+        _adc = nullptr;
+        _hits = nullptr;
+        _dt.release();
+    }
+
+    bool allocated() const { return _adc != nullptr; }
+    void reset() { _dt.reset(); }
+    size_t retained() const { return _capacity; }
+    void service() {}
+    uint32_t stalls() const { return 0; }
+    uint32_t correctionsDropped() const { return _dt.dropped(); }
+
+    void writeRun(size_t index, const uint16_t* adc, const uint8_t* hits, size_t n,
+                  uint16_t firstDelta, uint16_t delta) {
+        memcpy(_adc + index, adc, n * sizeof(uint16_t));
+        _dt.writeRun(index, n, firstDelta, delta);
+        for (size_t i = 0; i < n; i++) sees_set_bit(_hits, index + i, hits[i]);
+    }
+
+    uint16_t adc(size_t index) const { return _adc[index]; }
+    uint16_t timeDelta(size_t index) const { return _dt.at(index); }
+    uint8_t hit(size_t index) const { return sees_test_bit(_hits, index); }
+
+private:
+    uint16_t* _adc;
+    uint32_t* _hits;
+    SparseDeltas _dt;
+    size_t _capacity;
+};
+
+/**
+ * @brief Bit-packed 12-bit layout with implied timing
+ *
+ * Two 12-bit ADC values share 3 bytes, hit flags are a bitset, and the
+ * time deltas are SparseDeltas (the nominal period plus corrections).
+ *
+ * 1.5 + 0.125 + 0.125 B/sample, plus a fixed correction table.
+ */
+class Packed12Storage {
+public:
+    static constexpr const char* NAME = "packed 12-bit 1.75 B/sample";
+
+    static constexpr size_t bitsetWords(size_t capacity) { return (capacity + 31) / 32; }
+    static constexpr size_t adcBytes(size_t capacity) { return (capacity + 1) / 2 * 3; }
+
+    static constexpr size_t bytesFor(size_t capacity) {
+        return adcBytes(capacity) + bitsetWords(capacity) * sizeof(uint32_t) +
+               SparseDeltas::bytesFor(capacity);
+    }
+
+    static constexpr size_t ramBytesFor(size_t capacity) { return bytesFor(capacity); }
+
+    Packed12Storage() : _adc(nullptr), _hits(nullptr), _capacity(0) {}
+    ~Packed12Storage() { release(); }
+
+    bool allocate(size_t capacity, uint16_t nominalDelta) {
+        release();
+        _adc = new (std::nothrow) uint8_t[adcBytes(capacity)];
+        _hits = new (std::nothrow) uint32_t[bitsetWords(capacity)];
+        if (!_adc || !_hits || !_dt.allocate(capacity, nominalDelta)) {
+            release();
+            return false;
+        }
+        _capacity = capacity;
+        memset(_hits, 0, bitsetWords(capacity) * sizeof(uint32_t));
+        return true;
+    }
+
+    void release() {
+        delete[] _adc;
+        delete[] _hits;
+        _adc = nullptr;
+        _hits = nullptr;
+        _dt.release();
+    }
+
+    bool allocated() const { return _adc != nullptr; }
+    void reset() { _dt.reset(); }
+    size_t retained() const { return _capacity; }
+    void service() {}
+    uint32_t stalls() const { return 0; }
+    uint32_t correctionsDropped() const { return _dt.dropped(); }
+
+    void writeRun(size_t index, const uint16_t* adc, const uint8_t* hits, size_t n,
+                  uint16_t firstDelta, uint16_t delta) {
+        for (size_t i = 0; i < n; i++) {
+            putAdc(index + i, adc[i]);
+            sees_set_bit(_hits, index + i, hits[i]);
+        }
+        _dt.writeRun(index, n, firstDelta, delta);
+    }
+
+    uint16_t adc(size_t index) const {
+        const uint8_t* p = _adc + (index >> 1) * 3;
+        if (index & 1) return (p[1] >> 4) | ((uint16_t)p[2] << 4);
+        return p[0] | ((uint16_t)(p[1] & 0x0F) << 8);
+    }
+
+    uint16_t timeDelta(size_t index) const { return _dt.at(index); }
+    uint8_t hit(size_t index) const { return sees_test_bit(_hits, index); }
+
+private:
+    uint8_t* _adc;
+    uint32_t* _hits;
+    SparseDeltas _dt;
+    size_t _capacity;
+
+    void putAdc(size_t index, uint16_t v) {
+        uint8_t* p = _adc + (index >> 1) * 3;
+        v &= 0x0FFF;
+        if (index & 1) {
+            p[1] = (p[1] & 0x0F) | (uint8_t)((v & 0x0F) << 4);
+            p[2] = (uint8_t)(v >> 4);
+        } else {
+            p[0] = (uint8_t)v;
+            p[1] = (p[1] & 0xF0) | (uint8_t)(v >> 8);
+        }
+    }
+};
+
+// Compressed pool size per channel (bytes), e.g. -DSEES_BUFFER_POOL_BYTES=262144
+#ifndef SEES_BUFFER_POOL_BYTES
+#define SEES_BUFFER_POOL_BYTES (384UL * 1024UL / SEES_CHANNELS)
+#endif
+
+/**
+ * @brief Lossless compressed layout (SampleCodec blocks in a byte pool)
+ *
+ * Slots are grouped into blocks of SEES_BLOCK_MAX_SAMPLES. The block being
+ * written is staged raw; once full it is encoded into a circular byte
+ * pool and recorded in a per-block index (offset, length) for random
+ * access. Reads of older blocks decode the whole block once into a cache,
+ * so a sequential snap decodes each block a single time.
+ *
+ * The pool, not the slot count, bounds the window: when it is full the
+ * oldest blocks are evicted and retained() shrinks. Quiet baseline data
+ * compresses to roughly 1 B/sample or less.
+ */
+class CompressedStorage {
+public:
+    static constexpr const char* NAME = "compressed blocks";
+    static constexpr size_t BLOCK = SEES_BLOCK_MAX_SAMPLES;
+    static constexpr size_t POOL_BYTES = SEES_BUFFER_POOL_BYTES;
+
+    struct BlockRef {
+        uint32_t offset;
+        uint16_t length;  // 0 = not held
+    };
+
+    static constexpr size_t blocksFor(size_t capacity) { return (capacity + BLOCK - 1) / BLOCK; }
+
+    static constexpr size_t bytesFor(size_t capacity) {
+        return POOL_BYTES + blocksFor(capacity) * sizeof(BlockRef);
+    }
+
+    static constexpr size_t ramBytesFor(size_t capacity) { return bytesFor(capacity); }
+
+    CompressedStorage()
+        : _pool(nullptr), _index(nullptr), _capacity(0), _blocks(0), _nominal(0),
+          _poolHead(0), _oldest(0), _held(0), _heldSamples(0),
+          _stageBlock(0), _stageCount(0), _cacheBlock(SIZE_MAX) {}
+    ~CompressedStorage() { release(); }
+
+    bool allocate(size_t capacity, uint16_t nominalDelta) {
+        release();
+        _pool = new (std::nothrow) uint8_t[POOL_BYTES];
+        _index = new (std::nothrow) BlockRef[blocksFor(capacity)];
+        if (!_pool || !_index) {
+            release();
+            return false;
+        }
+        _capacity = capacity;
+        _blocks = blocksFor(capacity);
+        _nominal = nominalDelta;
+        reset();
+        return true;
+    }
+
+    void release() {
+        delete[] _pool;
+        delete[] _index;
+        _pool = nullptr;
+        _index = nullptr;
+    }
+
+    bool allocated() const { return _pool != nullptr; }
+
+    void reset() {
+        for (size_t b = 0; b < _blocks; b++) _index[b].length = 0;
+        _poolHead = 0;
+        _oldest = 0;
+        _held = 0;
+        _heldSamples = 0;
+        _stageBlock = 0;
+        _stageCount = 0;
+        _cacheBlock = SIZE_MAX;
+    }
+
+    size_t retained() const { return _heldSamples + _stageCount; }
+    void service() {}
+    uint32_t stalls() const { return 0; }
+    uint32_t correctionsDropped() const { return 0; }
+
+    void writeRun(size_t index, const uint16_t* adc, const uint8_t* hits, size_t n,
+                  uint16_t firstDelta, uint16_t delta) {
+        for (size_t i = 0; i < n; i++) {
+            size_t slot = index + i;
+            if (_stageCount == 0) {
+                _stageBlock = slot / BLOCK;
+                // Overwriting a held block - it is always the oldest
+                while (_index[_stageBlock].length) evictOldest();
+            }
+
+            _stage.adc[_stageCount] = adc[i];
+            _stage.hits[_stageCount] = hits[i];
+            _stage.delta[_stageCount] = (i == 0) ? firstDelta : delta;
+            _stageCount++;
+
+            if (_stageCount == blockLength(_stageBlock)) flushStage();
+        }
+    }
+
+    uint16_t adc(size_t index) const {
+        size_t off;
+        const Block* b = blockFor(index, off);
+        return b ? b->adc[off] : 0;
+    }
+
+    uint16_t timeDelta(size_t index) const {
+        size_t off;
+        const Block* b = blockFor(index, off);
+        return b ? b->delta[off] : _nominal;
+    }
+
+    uint8_t hit(size_t index) const {
+        size_t off;
+        const Block* b = blockFor(index, off);
+        return b ? b->hits[off] : 0;
+    }
+
+    /**
+     * @brief Pool bytes holding encoded blocks (for compression stats)
+     */
+    size_t poolUsed() const {
+        size_t used = 0;
+        for (size_t k = 0, b = _oldest; k < _held; k++, b = nextBlock(b)) used += _index[b].length;
+        return used;
+    }
+
+private:
+    struct Block {
+        uint16_t adc[BLOCK];
+        uint16_t delta[BLOCK];
+        uint8_t hits[BLOCK];
+    };
+
+    uint8_t* _pool;
+    BlockRef* _index;
+    size_t _capacity;
+    size_t _blocks;
+    uint16_t _nominal;
+
+    size_t _poolHead;     // next write offset
+    size_t _oldest;       // oldest held block
+    size_t _held;         // held (encoded) blocks
+    size_t _heldSamples;
+
+    Block _stage;         // block being written
+    size_t _stageBlock;
+    size_t _stageCount;
+
+    mutable Block _cache;  // last decoded block
+    mutable size_t _cacheBlock;
+    uint8_t _encoded[SEES_BLOCK_MAX_BYTES];
+
+    size_t blockLength(size_t b) const {
+        size_t start = b * BLOCK;
+        return (_capacity - start < BLOCK) ? _capacity - start : BLOCK;
+    }
+
+    size_t nextBlock(size_t b) const { return (b + 1 == _blocks) ? 0 : b + 1; }
+
+    void evictOldest() {
+        if (_held == 0) return;
+        _index[_oldest].length = 0;
+        _heldSamples -= blockLength(_oldest);
+        if (_cacheBlock == _oldest) _cacheBlock = SIZE_MAX;
+        _oldest = nextBlock(_oldest);
+        _held--;
+    }
+
+    /**
+     * @brief Evict oldest blocks until len contiguous pool bytes are free at _poolHead
+     */
+    void makeRoom(size_t len) {
+        for (;;) {
+            if (_held == 0) {
+                _poolHead = 0;
+                return;
+            }
+            size_t tail = _index[_oldest].offset;
+            if (_poolHead > tail) {
+                // Held data is [tail, head): use the end, else wrap to the start
+                if (POOL_BYTES - _poolHead >= len) return;
+                _poolHead = 0;
+                continue;
+            }
+            // Held data wraps: free space is [head, tail)
+            if (tail - _poolHead >= len) return;
+            evictOldest();
+        }
+    }
+
+    void flushStage() {
+        size_t len = sees_block_encode(_stage.adc, _stage.hits, _stage.delta, _stageCount,
+                                       _nominal, _encoded, sizeof(_encoded));
+        makeRoom(len);
+        memcpy(_pool + _poolHead, _encoded, len);
+
+        if (_held == 0) _oldest = _stageBlock;
+        _index[_stageBlock].offset = (uint32_t)_poolHead;
+        _index[_stageBlock].length = (uint16_t)len;
+        _poolHead += len;
+        _held++;
+        _heldSamples += _stageCount;
+        if (_cacheBlock == _stageBlock) _cacheBlock = SIZE_MAX;
+
+        _stageCount = 0;
+    }
+
+    const Block* blockFor(size_t index, size_t& off) const {
+        size_t b = index / BLOCK;
+        off = index - b * BLOCK;
+        if (b == _stageBlock && _stageCount > 0) {
+            return off < _stageCount ? &_stage : nullptr;
+        }
+        if (_index[b].length == 0) return nullptr;
+        if (_cacheBlock != b) {
+            sees_block_decode(_pool + _index[b].offset, _index[b].length,
+                              _cache.adc, _cache.hits, _cache.delta);
+            _cacheBlock = b;
+        }
+        return &_cache;
+    }
+};
+
+// Hot ring size in blocks, e.g. -DSEES_HOT_BLOCKS=32
+#ifndef SEES_HOT_BLOCKS
+#define SEES_HOT_BLOCKS 16
+#endif
+
+/**
+ * @brief Two-tier layout: RAM hot ring in front of SoA arrays in PSRAM
+ *
+ * Writes land in a small ring of 256-sample blocks in internal RAM. The
+ * SoA arrays for every slot live in external PSRAM (extmem_malloc), and
+ * service() copies completed blocks there. The copy is deferred, not
+ * asynchronous: service() runs in loop() between sample blocks and
+ * memcpy()s at most FLUSH_PER_SERVICE blocks per call, so it costs loop
+ * time but never happens inside a recordBlock() unless the ring is full.
+ * Reads check the hot ring first, then PSRAM, so the two tiers look like
+ * one ring.
+ *
+ * If service() falls so far behind that the hot ring is full, the writer
+ * flushes the oldest block inline - a stall, counted by stalls().
+ */
+class TieredStorage {
+public:
+    static constexpr const char* NAME = "tiered: RAM hot ring + PSRAM SoA";
+    static constexpr size_t BLOCK = 256;
+    static constexpr size_t HOT_BLOCKS = SEES_HOT_BLOCKS;
+    static constexpr size_t FLUSH_PER_SERVICE = 2;
+
+    static_assert(HOT_BLOCKS >= 2, "hot ring needs room for a block being written");
+
+    struct HotBlock {
+        uint16_t adc[BLOCK];
+        uint16_t dt[BLOCK];
+        uint32_t hits[BLOCK / 32];
+    };
+
+    static constexpr size_t bitsetWords(size_t capacity) { return (capacity + 31) / 32; }
+
+    static constexpr size_t bytesFor(size_t capacity) {
+        return capacity * 2 * sizeof(uint16_t) + bitsetWords(capacity) * sizeof(uint32_t) +
+               HOT_BLOCKS * sizeof(HotBlock);
+    }
+
+    static constexpr size_t ramBytesFor(size_t /*capacity*/) {
+        return HOT_BLOCKS * sizeof(HotBlock);
+    }
+
+    TieredStorage()
+        : _adc(nullptr), _dt(nullptr), _hits(nullptr), _hot(nullptr),
+          _capacity(0), _blocks(0), _hotTail(0), _pendingFirst(0), _pendingCount(0),
+          _fill(0), _stalls(0) {}
+    ~TieredStorage() { release(); }
+
+    bool allocate(size_t capacity, uint16_t /*nominalDelta*/) {
+        release();
+        _adc = (uint16_t*)extmem_malloc(capacity * sizeof(uint16_t));
+        _dt = (uint16_t*)extmem_malloc(capacity * sizeof(uint16_t));
+        _hits = (uint32_t*)extmem_malloc(bitsetWords(capacity) * sizeof(uint32_t));
+        _hot = new (std::nothrow) HotBlock[HOT_BLOCKS];
+        if (!_adc || !_dt || !_hits || !_hot) {
+            release();
+            return false;
+        }
+        memset(_hits, 0, bitsetWords(capacity) * sizeof(uint32_t));
+        _capacity = capacity;
+        _blocks = (capacity + BLOCK - 1) / BLOCK;
+        reset();
+        return true;
+    }
+
+    void release() {
+        extmem_free(_adc);
+        extmem_free(_dt);
+        extmem_free(_hits);
+        delete[] _hot;
+        _adc = nullptr;
+        _dt = nullptr;
+        _hits = nullptr;
+        _hot = nullptr;
+    }
+
+    bool allocated() const { return _adc != nullptr; }
+
+    void reset() {
+        _hotTail = 0;
+        _pendingFirst = 0;
+        _pendingCount = 0;
+        _fill = 0;
+    }
+
+    size_t retained() const { return _capacity; }
+
+    /**
+     * @brief Copy up to FLUSH_PER_SERVICE completed blocks to PSRAM (synchronously)
+     */
+    void service() {
+        for (size_t k = 0; k < FLUSH_PER_SERVICE && completedPending() > 0; k++) {
+            flushOldest();
+        }
+    }
+
+    void writeRun(size_t index, const uint16_t* adc, const uint8_t* hits, size_t n,
+                  uint16_t firstDelta, uint16_t delta) {
+        size_t done = 0;
+        while (done < n) {
+            size_t slot = index + done;
+            size_t b = slot / BLOCK;
+            size_t off = slot - b * BLOCK;
+            if (_pendingCount == 0 || off == 0) openBlock(b);
+
+            size_t run = blockLength(b) - off;
+            if (run > n - done) run = n - done;
+
+            HotBlock& h = _hot[hotIndex(_pendingCount - 1)];
+            memcpy(h.adc + off, adc + done, run * sizeof(uint16_t));
+            for (size_t i = 0; i < run; i++) {
+                h.dt[off + i] = (done + i == 0) ? firstDelta : delta;
+                uint32_t mask = 1UL << ((off + i) & 31);
+                if (hits[done + i]) h.hits[(off + i) >> 5] |= mask;
+                else                h.hits[(off + i) >> 5] &= ~mask;
+            }
+
+            _fill = off + run;
+            done += run;
+        }
+    }
+
+    uint16_t adc(size_t index) const {
+        size_t off;
+        const HotBlock* h = hotFor(index, off);
+        return h ? h->adc[off] : _adc[index];
+    }
+
+    uint16_t timeDelta(size_t index) const {
+        size_t off;
+        const HotBlock* h = hotFor(index, off);
+        return h ? h->dt[off] : _dt[index];
+    }
+
+    uint8_t hit(size_t index) const {
+        size_t off;
+        const HotBlock* h = hotFor(index, off);
+        if (h) return (h->hits[off >> 5] >> (off & 31)) & 1;
+        return (_hits[index >> 5] >> (index & 31)) & 1;
+    }
+
+    /**
+     * @brief Blocks the writer flushed inline because the hot ring was full
+     */
+    uint32_t stalls() const { return _stalls; }
+    uint32_t correctionsDropped() const { return 0; }
+
+private:
+    // Cold tier (PSRAM), indexed by slot
+    uint16_t* _adc;
+    uint16_t* _dt;
+    uint32_t* _hits;
+
+    // Hot tier: FIFO of blocks not yet flushed, newest possibly partial
+    HotBlock* _hot;
+    size_t _capacity;
+    size_t _blocks;
+    size_t _hotTail;       // hot index of the oldest pending block
+    size_t _pendingFirst;  // block number of the oldest pending block
+    size_t _pendingCount;
+    size_t _fill;          // samples written into the newest pending block
+    uint32_t _stalls;
+
+    size_t blockLength(size_t b) const {
+        size_t start = b * BLOCK;
+        return (_capacity - start < BLOCK) ? _capacity - start : BLOCK;
+    }
+
+    size_t hotIndex(size_t k) const { return (_hotTail + k) % HOT_BLOCKS; }
+
+    size_t completedPending() const {
+        if (_pendingCount == 0) return 0;
+        size_t newest = (_pendingFirst + _pendingCount - 1) % _blocks;
+        return (_fill == blockLength(newest)) ? _pendingCount : _pendingCount - 1;
+    }
+
+    void openBlock(size_t b) {
+        // Hot ring full, or (tiny rings) block b itself is still pending
+        if (_pendingCount == HOT_BLOCKS || _pendingCount == _blocks) {
+            flushOldest();
+            _stalls++;
+        }
+        if (_pendingCount == 0) _pendingFirst = b;
+        _pendingCount++;
+        _fill = 0;
+    }
+
+    void flushOldest() {
+        const HotBlock& h = _hot[_hotTail];
+        size_t start = _pendingFirst * BLOCK;
+        size_t len = blockLength(_pendingFirst);
+
+        memcpy(_adc + start, h.adc, len * sizeof(uint16_t));
+        memcpy(_dt + start, h.dt, len * sizeof(uint16_t));
+        memcpy(_hits + start / 32, h.hits, ((len + 31) / 32) * sizeof(uint32_t));
+
+        _hotTail = (_hotTail + 1) % HOT_BLOCKS;
+        _pendingFirst = (_pendingFirst + 1 == _blocks) ? 0 : _pendingFirst + 1;
+        _pendingCount--;
+    }
+
+    /**
+     * @brief Hot block holding slot index, or nullptr if it is in PSRAM
+     */
+    const HotBlock* hotFor(size_t index, size_t& off) const {
+        if (_pendingCount == 0) return nullptr;
+        size_t b = index / BLOCK;
+        size_t k = (b >= _pendingFirst) ? b - _pendingFirst : b + _blocks - _pendingFirst;
+        if (k >= _pendingCount) return nullptr;
+        off = index - b * BLOCK;
+        // Unwritten tail of the newest block still holds older samples in PSRAM
+        if (k == _pendingCount - 1 && off >= _fill) return nullptr;
+        return &_hot[hotIndex(k)];
+    }
+};
+
+#if defined(SEES_BUFFER_AOS)
+using SampleStorage = AosStorage;
+#elif defined(SEES_BUFFER_PACKED)
+using SampleStorage = Packed12Storage;
+#elif defined(SEES_BUFFER_COMPRESSED)
+using SampleStorage = CompressedStorage;
+#elif defined(SEES_BUFFER_TIERED)
+using SampleStorage = TieredStorage;
+#else
+using SampleStorage = SoaStorage;
+#endif
+
+#endif // SAMPLE_STORAGE_HPP
@@ -0,0 +1,572 @@
+#!/usr/bin/env python3
+"""
+SEEs Binary Frame Decoder
+
+Decodes the binary frames emitted by the firmware (see SEEs_Interface.hpp).
+Frames share the serial link with normal text lines, so the decoder splits
+an incoming byte stream into plain text and CRC-checked frames.
+
+Frame layout (little-endian):
+    [A5 5A][type u8][reserved u8][seq u16][length u16][payload][crc16 u16]
+
+CRC is CRC-16/CCITT (init 0xFFFF, poly 0x1021) over header + payload.
+
+Usage:
+    decoder = FrameDecoder()
+    text, frames = decoder.feed(data)
+    for frame in frames:
+        if frame.type == FRAME_SAMPLES:
+            rows = decode_sample_batch(frame.payload)
+
+Also decodes SampleCodec blocks (compressed buffer mode, SampleCodec.hpp)
+with decode_sample_block(), and rebuilds binary snap exports
+(FRAME_SNAP_HEADER / FRAME_SNAP_DATA / FRAME_SNAP_END) with SnapAssembler.
+Event streaming frames (FRAME_EVENT / FRAME_SUMMARY) decode with
+decode_event() and decode_summary(); layer coincidences (FRAME_COINCIDENCE,
+or the text-mode "[SEEs] Coincidence" line) with decode_coincidence() and
+parse_coincidence_line(); pulse peak histograms (FRAME_HISTOGRAM, or the
+text-mode "[SEEs] Histogram" lines) with decode_histogram() and
+parse_histogram_line(); per-hit pulse records (FRAME_PULSE, or the text-mode
+"[SEEs] Pulse" line) with decode_pulse() and parse_pulse_line(); dead/live
+time records (FRAME_STATS, or the text-mode "[SEEs] Stats at" lines) with
+decode_stats() and parse_stats_line().
+"""
+
+import re
+import struct
+from collections import namedtuple
+
+SYNC = b'\xa5\x5a'
+HEADER_FMT = '<2sBBHH'
+HEADER_SIZE = struct.calcsize(HEADER_FMT)
+MAX_PAYLOAD = 1024
+
+# Frame types
+FRAME_SAMPLES = 0x01
+FRAME_SNAP_HEADER = 0x02
+FRAME_SNAP_DATA = 0x03
+FRAME_SNAP_END = 0x04
+SNAP_FRAME_TYPES = (FRAME_SNAP_HEADER, FRAME_SNAP_DATA, FRAME_SNAP_END)
+FRAME_EVENT = 0x05
+FRAME_SUMMARY = 0x06
+FRAME_COINCIDENCE = 0x07
+FRAME_HISTOGRAM = 0x08
+FRAME_PULSE = 0x09
+FRAME_STATS = 0x0A
+
+# Binary snap payloads (SEEsSnapHeader / SEEsSnapData / SEEsSnapEnd)
+SNAP_HEADER_FMT = '<IIIHBBf'
+SNAP_DATA_FMT = '<III'
+SNAP_END_FMT = '<IIII'
+SNAP_BLOCK_SAMPLES = 128
+
+# Event streaming (SEEsEventHeader + samples / SEEsSummary)
+EVENT_HEADER_FMT = '<IIHHHHI'
+EVENT_HEADER_SIZE = struct.calcsize(EVENT_HEADER_FMT)
+EVENT_MAX_SAMPLES = 256
+SUMMARY_FMT = '<IIIIIIff'
+SUMMARY_PILEUP_FMT = '<II'  # appended pileups, dead_us (absent from older firmware)
+
+# Layer coincidence (SEEsCoincidence)
+COINC_FMT = '<IHBB'
+COINC_CSV_HEADER = 'time_ms,depth,layer_mask,spread_us'
+
+# Pulse peak histogram (SEEsHistogram): counts[4][8]
+HIST_LAYERS = 4
+HIST_BINS = 8
+HIST_FMT = f'<IIBBHH{HIST_LAYERS * HIST_BINS}H'
+HIST_CSV_HEADER = 'time_ms,window_ms,layer,' + ','.join(f'bin{i}' for i in range(HIST_BINS))
+
+# Pulse record (SEEsPulse)
+PULSE_FMT = '<IIHHHHBB'
+PULSE_CSV_HEADER = 'time_ms,layer,peak_V,pedestal_V,integral_adc,rise_us,duration_us,peaks'
+
+# Dead/live time record (SEEsStats): hits[4], dead_us[4], dt_dropped
+STATS_LAYERS = 4
+STATS_FMT = f'<IIIIIIHBB{STATS_LAYERS}I{STATS_LAYERS}II'
+STATS_CSV_HEADER = ('time_ms,period_ms,layer,slots,lost_slots,lost_in_snap,overruns,'
+                    'max_backlog,dt_dropped,hits,dead_us,live')
+
+# SEEsSampleBatch
+STREAM_BATCH = 32
+SAMPLE_HIT_BIT = 0x8000
+SAMPLE_BATCH_FMT = f'<IHHI{STREAM_BATCH}H'
+
+# SampleCodec block (see SampleCodec.hpp)
+BLOCK_HEADER_FMT = '<BBBBHHH'
+BLOCK_HEADER_SIZE = struct.calcsize(BLOCK_HEADER_FMT)
+BLOCK_MAX_SAMPLES = 256
+BLOCK_MAX_HIT_LIST = 32
+BLOCK_HIT_BITSET = 0xFF
+
+# ADC scaling (12-bit, 3.3V reference)
+ADC_VREF = 3.3
+ADC_MAX = 4095
+
+Frame = namedtuple('Frame', ['type', 'seq', 'payload'])
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    """CRC-16/CCITT matching crc16_ccitt() in SEEs_Interface.cpp."""
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            if crc & 0x8000:
+                crc = ((crc << 1) ^ 0x1021) & 0xFFFF
+            else:
+                crc = (crc << 1) & 0xFFFF
+    return crc
+
+
+def encode_frame(frame_type, seq, payload):
+    """Build a frame exactly as sees_frame_encode() does (used by tests/sims)."""
+    header = struct.pack(HEADER_FMT, SYNC, frame_type, 0, seq & 0xFFFF, len(payload))
+    body = header + payload
+    return body + struct.pack('<H', crc16_ccitt(body))
+
+
+class FrameDecoder:
+    """Incremental splitter for mixed text/binary serial streams."""
+
+    def __init__(self):
+        self._buffer = b""
+        self.crc_errors = 0
+        self.frames_ok = 0
+        self.lost_frames = 0
+        self._last_seq = {}
+
+    def feed(self, data):
+        """
+        Add received bytes.
+
+        Returns:
+            (text, frames): bytes that are not part of a frame, and the
+            list of complete frames with a valid CRC.
+        """
+        self._buffer += data
+        text = bytearray()
+        frames = []
+
+        while True:
+            idx = self._buffer.find(SYNC)
+            if idx < 0:
+                # Keep a trailing first sync byte, it may start a frame
+                keep = 1 if self._buffer.endswith(SYNC[:1]) else 0
+                text += self._buffer[:len(self._buffer) - keep]
+                self._buffer = self._buffer[len(self._buffer) - keep:]
+                break
+
+            text += self._buffer[:idx]
+            self._buffer = self._buffer[idx:]
+
+            if len(self._buffer) < HEADER_SIZE:
+                break
+
+            _, ftype, _, seq, length = struct.unpack_from(HEADER_FMT, self._buffer)
+            if length > MAX_PAYLOAD:
+                # Not a real header - skip the sync byte and resync
+                self._buffer = self._buffer[1:]
+                continue
+
+            total = HEADER_SIZE + length + 2
+            if len(self._buffer) < total:
+                break
+
+            body = self._buffer[:HEADER_SIZE + length]
+            (crc,) = struct.unpack_from('<H', self._buffer, HEADER_SIZE + length)
+            if crc != crc16_ccitt(body):
+                self.crc_errors += 1
+                self._buffer = self._buffer[1:]
+                continue
+
+            self._track_seq(ftype, seq)
+            frames.append(Frame(ftype, seq, bytes(body[HEADER_SIZE:])))
+            self.frames_ok += 1
+            self._buffer = self._buffer[total:]
+
+        return bytes(text), frames
+
+    def _track_seq(self, ftype, seq):
+        last = self._last_seq.get(ftype)
+        if last is not None:
+            self.lost_frames += (seq - last - 1) & 0xFFFF
+        self._last_seq[ftype] = seq
+
+
+def adc_to_volts(raw):
+    """Convert a raw 12-bit ADC count to volts."""
+    return raw * ADC_VREF / ADC_MAX
+
+
+def decode_sample_batch(payload):
+    """
+    Decode a FRAME_SAMPLES payload into stream rows.
+
+    Returns:
+        List of (time_ms, voltage_V, hit, total_hits) tuples, the same
+        columns as the text stream.
+    """
+    fields = struct.unpack(SAMPLE_BATCH_FMT, payload)
+    t0_us, dt_us, count, total_hits = fields[:4]
+    samples = fields[4:4 + count]
+
+    # total_hits is the count after the last sample; walk back for the running value
+    hits_after = sum(1 for s in samples if s & SAMPLE_HIT_BIT)
+    running = total_hits - hits_after
+
+    rows = []
+    for i, s in enumerate(samples):
+        hit = 1 if s & SAMPLE_HIT_BIT else 0
+        running += hit
+        time_ms = (t0_us + i * dt_us) / 1000.0
+        rows.append((time_ms, adc_to_volts(s & 0x0FFF), hit, running))
+    return rows
+
+
+Event = namedtuple('Event', ['event_id', 't0_us', 'trigger_index', 'hits', 'rows'])
+Summary = namedtuple('Summary', ['t_us', 'period_us', 'samples', 'hits', 'total_hits',
+                                 'events', 'baseline_V', 'noise_V', 'rate_hz',
+                                 'pileups', 'dead_us', 'pileup_fraction', 'dead_fraction'])
+
+
+def decode_event(payload):
+    """
+    Decode a FRAME_EVENT payload.
+
+    Returns:
+        Event whose rows are (time_ms, voltage_V, hit, total_hits) tuples,
+        the same columns as the stream.
+    """
+    event_id, t0_us, dt_us, count, trigger_index, hits, total_hits = \
+        struct.unpack_from(EVENT_HEADER_FMT, payload)
+    samples = struct.unpack_from(f'<{count}H', payload, EVENT_HEADER_SIZE)
+
+    running = total_hits - hits
+    rows = []
+    for i, s in enumerate(samples):
+        hit = 1 if s & SAMPLE_HIT_BIT else 0
+        running += hit
+        rows.append(((t0_us + i * dt_us) / 1000.0, adc_to_volts(s & 0x0FFF), hit, running))
+    return Event(event_id, t0_us, trigger_index, hits, rows)
+
+
+def decode_summary(payload):
+    """
+    Decode a FRAME_SUMMARY payload (baseline and noise in volts).
+
+    pileup_fraction is the share of particles that arrived on top of another
+    pulse, dead_fraction the share of the period the layer could not trigger;
+    rate_hz / (1 - dead_fraction) corrects the rate for dead time.
+    """
+    t_us, period_us, samples, hits, total_hits, events, baseline, noise = \
+        struct.unpack_from(SUMMARY_FMT, payload)
+    pileups, dead_us = 0, 0
+    if len(payload) >= struct.calcsize(SUMMARY_FMT) + struct.calcsize(SUMMARY_PILEUP_FMT):
+        pileups, dead_us = struct.unpack_from(SUMMARY_PILEUP_FMT, payload,
+                                              struct.calcsize(SUMMARY_FMT))
+    rate_hz = hits * 1e6 / period_us if period_us else 0.0
+    pileup_fraction = pileups / (hits + pileups) if hits + pileups else 0.0
+    dead_fraction = min(dead_us / period_us, 1.0) if period_us else 0.0
+    return Summary(t_us, period_us, samples, hits, total_hits, events,
+                   adc_to_volts(baseline), adc_to_volts(noise), rate_hz,
+                   pileups, dead_us, pileup_fraction, dead_fraction)
+
+
+Coincidence = namedtuple('Coincidence', ['time_ms', 'depth', 'layer_mask', 'spread_us'])
+
+_COINC_LINE = re.compile(r'\[SEEs\] Coincidence at ([\d.]+) ms: depth (\d+), '
+                         r'layers ([\d+]+), spread (\d+) us')
+
+
+def decode_coincidence(payload):
+    """Decode a FRAME_COINCIDENCE payload."""
+    t_us, spread_us, mask, depth = struct.unpack(COINC_FMT, payload)
+    return Coincidence(t_us / 1000.0, depth, mask, spread_us)
+
+
+def parse_coincidence_line(line):
+    """Parse the text-mode coincidence line; None if it is not one."""
+    m = _COINC_LINE.search(line)
+    if not m:
+        return None
+    mask = 0
+    for layer in m.group(3).split('+'):
+        mask |= 1 << int(layer)
+    return Coincidence(float(m.group(1)), int(m.group(2)), mask, int(m.group(4)))
+
+
+def format_coincidence(c):
+    """Format a coincidence as a COINC_CSV_HEADER row."""
+    return f"{c.time_ms:.3f},{c.depth},{c.layer_mask},{c.spread_us}"
+
+
+Histogram = namedtuple('Histogram', ['time_ms', 'window_ms', 'min_V', 'bin_V', 'counts'])
+HistogramRow = namedtuple('HistogramRow', ['time_ms', 'window_ms', 'layer', 'counts'])
+
+_HIST_LINE = re.compile(r'\[SEEs\] Histogram at ([\d.]+) ms \((\d+) ms\), layer (\d+):((?: \d+)+)')
+
+
+def decode_histogram(payload):
+    """Decode a FRAME_HISTOGRAM payload; counts holds one list per layer in use."""
+    fields = struct.unpack(HIST_FMT, payload)
+    t_us, window_us, layers, bins, min_adc, bin_adc = fields[:6]
+    flat = fields[6:]
+    counts = [list(flat[l * HIST_BINS:l * HIST_BINS + bins]) for l in range(layers)]
+    return Histogram(t_us / 1000.0, window_us / 1000.0, adc_to_volts(min_adc),
+                     adc_to_volts(bin_adc), counts)
+
+
+def histogram_rows(hist):
+    """Split a decoded histogram into per-layer rows."""
+    return [HistogramRow(hist.time_ms, hist.window_ms, layer, counts)
+            for layer, counts in enumerate(hist.counts)]
+
+
+def parse_histogram_line(line):
+    """Parse one text-mode histogram line (one layer); None if it is not one."""
+    m = _HIST_LINE.search(line)
+    if not m:
+        return None
+    return HistogramRow(float(m.group(1)), float(m.group(2)), int(m.group(3)),
+                        [int(c) for c in m.group(4).split()])
+
+
+def format_histogram_row(row):
+    """Format a histogram row as a HIST_CSV_HEADER line."""
+    return (f"{row.time_ms:.3f},{row.window_ms:.0f},{row.layer},"
+            + ','.join(str(c) for c in row.counts))
+
+
+Pulse = namedtuple('Pulse', ['time_ms', 'layer', 'peak_V', 'pedestal_V', 'integral_adc',
+                             'rise_us', 'duration_us', 'peaks'])
+
+_PULSE_LINE = re.compile(r'\[SEEs\] Pulse layer (\d+) at ([\d.]+) ms: peak (\d+), '
+                         r'pedestal (\d+), integral (\d+), rise (\d+) us, duration (\d+) us'
+                         r'(?:, peaks (\d+))?')
+
+
+def decode_pulse(payload):
+    """
+    Decode a FRAME_PULSE payload (integral stays in ADC counts x samples).
+
+    peaks > 1 marks pile-up; older firmware sends 0 there, read as 1.
+    """
+    t_us, integral, peak, pedestal, rise_us, duration_us, layer, peaks = \
+        struct.unpack(PULSE_FMT, payload)
+    return Pulse(t_us / 1000.0, layer, adc_to_volts(peak), adc_to_volts(pedestal),
+                 integral, rise_us, duration_us, max(peaks, 1))
+
+
+def parse_pulse_line(line):
+    """Parse the text-mode pulse line; None if it is not one."""
+    m = _PULSE_LINE.search(line)
+    if not m:
+        return None
+    layer, t_ms, peak, pedestal, integral, rise_us, duration_us, peaks = m.groups()
+    return Pulse(float(t_ms), int(layer), adc_to_volts(int(peak)),
+                 adc_to_volts(int(pedestal)), int(integral), int(rise_us), int(duration_us),
+                 int(peaks) if peaks else 1)
+
+
+def format_pulse(p):
+    """Format a pulse as a PULSE_CSV_HEADER row."""
+    return (f"{p.time_ms:.3f},{p.layer},{p.peak_V:.4f},{p.pedestal_V:.4f},"
+            f"{p.integral_adc},{p.rise_us},{p.duration_us},{p.peaks}")
+
+
+StatsRow = namedtuple('StatsRow', ['time_ms', 'period_ms', 'layer', 'slots', 'lost_slots',
+                                   'lost_in_snap', 'overruns', 'max_backlog', 'dt_dropped',
+                                   'hits', 'dead_us', 'live'])
+
+_STATS_LINE = re.compile(r'\[SEEs\] Stats at ([\d.]+) ms \((\d+) ms\), layer (\d+): slots (\d+), '
+                         r'lost (\d+) \((\d+) in snaps\), overruns (\d+), backlog (\d+), '
+                         r'dt dropped (\d+), hits (\d+), dead (\d+) us')
+
+
+def _live_fraction(period_us, slots, lost_slots, dead_us):
+    """Share of the period a layer could trigger (not dead, not in a lost slot)."""
+    if not period_us:
+        return 0.0
+    lost_us = lost_slots * period_us / (slots + lost_slots)
+    return max(0.0, 1.0 - (dead_us + lost_us) / period_us)
+
+
+def decode_stats(payload):
+    """Decode a FRAME_STATS payload into one StatsRow per layer in use."""
+    fields = struct.unpack(STATS_FMT, payload)
+    t_us, period_us, slots, lost, lost_in_snap, overruns, backlog, layers, _ = fields[:9]
+    hits = fields[9:9 + STATS_LAYERS]
+    dead = fields[9 + STATS_LAYERS:9 + 2 * STATS_LAYERS]
+    dt_dropped = fields[9 + 2 * STATS_LAYERS]
+    return [StatsRow(t_us / 1000.0, period_us / 1000.0, layer, slots, lost, lost_in_snap, overruns,
+                     backlog, dt_dropped, hits[layer], dead[layer],
+                     _live_fraction(period_us, slots, lost, dead[layer]))
+            for layer in range(layers)]
+
+
+def parse_stats_line(line):
+    """Parse one text-mode stats line (one layer); None if it is not one."""
+    m = _STATS_LINE.search(line)
+    if not m:
+        return None
+    t_ms, period_ms = float(m.group(1)), float(m.group(2))
+    layer, slots, lost, lost_in_snap, overruns, backlog, dt_dropped, hits, dead = \
+        (int(g) for g in m.groups()[2:])
+    return StatsRow(t_ms, period_ms, layer, slots, lost, lost_in_snap, overruns, backlog,
+                    dt_dropped, hits, dead,
+                    _live_fraction(period_ms * 1000, slots, lost, dead))
+
+
+def format_stats_row(row):
+    """Format a stats row as a STATS_CSV_HEADER line."""
+    return (f"{row.time_ms:.3f},{row.period_ms:.0f},{row.layer},{row.slots},{row.lost_slots},"
+            f"{row.lost_in_snap},{row.overruns},{row.max_backlog},{row.dt_dropped},{row.hits},"
+            f"{row.dead_us},{row.live:.5f}")
+
+
+def format_row(row):
+    """Format a decoded row like the firmware text stream."""
+    time_ms, voltage, hit, total_hits = row
+    return f"{time_ms:.3f},{voltage:.4f},{hit},{total_hits}"
+
+
+def _zigzag(v):
+    return (v << 1) if v >= 0 else ((-v) << 1) - 1
+
+
+def _unzigzag(v):
+    return (v >> 1) ^ -(v & 1)
+
+
+def encode_sample_block(adc, hits, deltas, nominal_dt):
+    """Encode samples exactly as sees_block_encode() does (used by tests/sims)."""
+    n = len(adc)
+    if n == 0 or n > BLOCK_MAX_SAMPLES:
+        raise ValueError("block must hold 1..256 samples")
+
+    zz = [_zigzag(adc[i] - adc[i - 1]) for i in range(1, n)]
+    width = max(zz, default=0).bit_length()
+    hit_pos = [i for i in range(n) if hits[i]]
+    corr = [(i, d) for i, d in enumerate(deltas) if d != nominal_dt]
+    bitset = len(hit_pos) > BLOCK_MAX_HIT_LIST
+
+    out = bytearray(struct.pack(BLOCK_HEADER_FMT, n - 1, width,
+                                BLOCK_HIT_BITSET if bitset else len(hit_pos), 0,
+                                adc[0], nominal_dt, len(corr)))
+    if bitset:
+        bits = bytearray(BLOCK_MAX_SAMPLES // 8)
+        for i in hit_pos:
+            bits[i >> 3] |= 1 << (i & 7)
+        out += bits
+    else:
+        out += bytes(hit_pos)
+    for i, d in corr:
+        out += struct.pack('<BH', i, d)
+
+    acc = nbits = 0
+    for v in zz:
+        acc |= v << nbits
+        nbits += width
+    out += acc.to_bytes((nbits + 7) // 8, 'little')
+    return bytes(out)
+
+
+def decode_sample_block(data):
+    """
+    Decode one SampleCodec block.
+
+    Returns:
+        (adc, hits, deltas, size): per-sample lists and the encoded size
+        in bytes, so consecutive blocks can be walked.
+    """
+    n1, width, hit_count, _, adc0, nominal_dt, corr_count = \
+        struct.unpack_from(BLOCK_HEADER_FMT, data)
+    n = n1 + 1
+    pos = BLOCK_HEADER_SIZE
+
+    hits = [0] * n
+    if hit_count == BLOCK_HIT_BITSET:
+        for i in range(n):
+            hits[i] = (data[pos + (i >> 3)] >> (i & 7)) & 1
+        pos += BLOCK_MAX_SAMPLES // 8
+    else:
+        for p in data[pos:pos + hit_count]:
+            hits[p] = 1
+        pos += hit_count
+
+    deltas = [nominal_dt] * n
+    for _ in range(corr_count):
+        i, d = struct.unpack_from('<BH', data, pos)
+        deltas[i] = d
+        pos += 3
+
+    nbytes = ((n - 1) * width + 7) // 8
+    acc = int.from_bytes(data[pos:pos + nbytes], 'little')
+    pos += nbytes
+
+    mask = (1 << width) - 1
+    adc = [adc0]
+    for i in range(1, n):
+        adc.append((adc[-1] + _unzigzag((acc >> ((i - 1) * width)) & mask)) & 0x0FFF)
+    return adc, hits, deltas, pos
+
+
+SnapHeader = namedtuple('SnapHeader', ['snap_id', 'sample_count', 'end_us', 'dt_us',
+                                       'adc_bits', 'adc_vref'])
+SnapEnd = namedtuple('SnapEnd', ['snap_id', 'samples_sent', 'samples_lost', 'hits'])
+
+
+class SnapAssembler:
+    """
+    Rebuild a binary snap export into the CSV snap rows.
+
+    Feed every snap frame; feed() returns the rows once the end frame
+    arrives. Time starts at 0 for the oldest sample; each block starts at
+    its first_us and accumulates the per-sample deltas, so samples lost on
+    the device and gaps too long for a delta keep later times exact.
+    """
+
+    def __init__(self):
+        self.header = None
+        self.end = None
+        self._rows = []
+        self._hits = 0
+
+    def feed(self, frame):
+        """Returns the list of rows when a snap completes, else None."""
+        if frame.type == FRAME_SNAP_HEADER:
+            snap_id, count, end_us, dt_us, bits, _, vref = \
+                struct.unpack(SNAP_HEADER_FMT, frame.payload)
+            self.header = SnapHeader(snap_id, count, end_us, dt_us, bits, vref)
+            self.end = None
+            self._rows = []
+            self._hits = 0
+            return None
+
+        if self.header is None:
+            return None
+
+        if frame.type == FRAME_SNAP_DATA:
+            snap_id, _, time_us = struct.unpack_from(SNAP_DATA_FMT, frame.payload)
+            if snap_id != self.header.snap_id:
+                return None
+            adc, hits, deltas, _ = decode_sample_block(
+                frame.payload[struct.calcsize(SNAP_DATA_FMT):])
+            scale = self.header.adc_vref / ((1 << self.header.adc_bits) - 1)
+
+            for i, raw in enumerate(adc):
+                if i > 0:
+                    time_us += deltas[i]
+                self._hits += hits[i]
+                self._rows.append((time_us / 1000.0, raw * scale, hits[i], self._hits))
+            return None
+
+        if frame.type == FRAME_SNAP_END:
+            self.end = SnapEnd(*struct.unpack(SNAP_END_FMT, frame.payload))
+            if self.end.snap_id != self.header.snap_id:
+                return None
+            rows = self._rows
+            self._rows = []
+            return rows
+
+        return None
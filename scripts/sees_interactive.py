@@ -7,7 +7,9 @@ The Teensy maintains the circular buffer and saves snaps to its SD card.
 This console logs the stream to the computer and forwards commands.
 
 Commands:
-- snap - Tell Teensy to save ±2.5s window to SD card
+- snap - Tell Teensy to save its buffer window (up to 2.5s past the trigger)
+- stream text|binary - Select live stream encoding (binary frames are
+  decoded back to CSV rows, see sees_frames.py)
 
 Directory structure:
 ~/Aeris/data/sees/YYYYMMDD.HHMM/
@@ -22,7 +24,7 @@ Usage:
     python3 sees_interactive.py /dev/ttyACM0 -v    # Verbose mode
 
 Controls:
-    snap   - Capture ±2.5s window (saved to Teensy SD card)
+    snap   - Capture the buffer window around now (saved to Teensy SD card)
     Ctrl+C - Exit
 """
 
@@ -32,6 +34,7 @@ import select
 import termios
 import tty
 import argparse
+import re
 from datetime import datetime
 from pathlib import Path
 import time
@@ -40,9 +43,24 @@ import stat
 import fcntl
 import subprocess
 
+from sees_frames import (FrameDecoder, FRAME_SAMPLES, FRAME_EVENT, FRAME_SUMMARY,
+                         FRAME_COINCIDENCE, FRAME_HISTOGRAM, FRAME_PULSE, FRAME_STATS,
+                         COINC_CSV_HEADER, HIST_CSV_HEADER, PULSE_CSV_HEADER, STATS_CSV_HEADER,
+                         SNAP_FRAME_TYPES, SnapAssembler,
+                         decode_coincidence, decode_event, decode_histogram, decode_pulse,
+                         decode_sample_batch, decode_stats, decode_summary, format_coincidence,
+                         format_histogram_row, format_pulse, format_row, format_stats_row,
+                         histogram_rows, parse_coincidence_line, parse_histogram_line,
+                         parse_pulse_line, parse_stats_line)
+
 # Configuration
 BAUD_RATE = 115200
 
+# Firmware replies that place a snap in time: the post-trigger wait of
+# "snap" / "snap <pre> <post>", or the hit a "snap hit" is centred on
+_SNAP_WAIT_LINE = re.compile(r'\[SEEs\] Waiting (\d+) ms for post-trigger data')
+_SNAP_HIT_LINE = re.compile(r'\[SEEs\] SNAP around hit (\d+)')
+
 
 class SubprocessSerial:
     """
@@ -191,6 +209,26 @@ def generate_stream_filename(session_timestamp):
     return f"SEEs.{session_timestamp}.stream.csv"
 
 
+def generate_coinc_filename(session_timestamp):
+    """Generate layer coincidence CSV filename"""
+    return f"SEEs.{session_timestamp}.coinc.csv"
+
+
+def generate_hist_filename(session_timestamp):
+    """Generate pulse peak histogram CSV filename"""
+    return f"SEEs.{session_timestamp}.hist.csv"
+
+
+def generate_pulse_filename(session_timestamp):
+    """Generate per-hit pulse record CSV filename"""
+    return f"SEEs.{session_timestamp}.pulse.csv"
+
+
+def generate_stats_filename(session_timestamp):
+    """Generate dead/live time record CSV filename"""
+    return f"SEEs.{session_timestamp}.stats.csv"
+
+
 def parse_data_line(line):
     """
     Parse CSV data line: time_ms,voltage_V,hit,total_hits
@@ -253,6 +291,89 @@ def is_data_like(line):
     return False
 
 
+def save_snap(session_dir, snap_data, snap_time, post_ms=None, hit_number=None):
+    """Write captured snap rows (CSV lines) to a snap file and report it.
+
+    The window is measured from the rows themselves, since its length depends
+    on the build (rate, layers, buffer layout) and on the snap command.
+    post_ms is the firmware's post-trigger wait, hit_number the hit a
+    "snap hit" was centred on; with neither the window cannot be placed around the trigger.
+    """
+    snap_filename = f"SEEs.{snap_time.strftime('%Y%m%d.%H%M.%S')}.csv"
+    snap_path = session_dir / snap_filename
+
+    # Count hits and classify by layer based on voltage
+    # Layer thresholds (midpoints between layer voltages):
+    # 1-layer: ~0.25V, 2-layer: ~0.40V, 3-layer: ~0.55V, 4-layer: ~0.70V
+    layer_counts = {1: 0, 2: 0, 3: 0, 4: 0}
+    prev_hit = 0
+    for s in snap_data:
+        parts = s.split(',')
+        if len(parts) >= 3:
+            try:
+                voltage = float(parts[1])
+                hit = int(parts[2])
+                # Only count on rising edge (transition from 0 to 1)
+                if hit == 1 and prev_hit == 0:
+                    # Classify by voltage level
+                    if voltage < 0.325:
+                        layer_counts[1] += 1
+                    elif voltage < 0.475:
+                        layer_counts[2] += 1
+                    elif voltage < 0.625:
+                        layer_counts[3] += 1
+                    else:
+                        layer_counts[4] += 1
+                prev_hit = hit
+            except ValueError:
+                pass
+
+    hits = sum(layer_counts.values())
+
+    # Window span from the first and last row times (device ms)
+    from datetime import timedelta
+    times = []
+    for s in snap_data:
+        try:
+            times.append(float(s.split(',')[0]))
+        except ValueError:
+            pass
+    first_ms = times[0] if times else 0.0
+    last_ms = times[-1] if times else 0.0
+    span_s = (last_ms - first_ms) / 1000.0
+
+    if hit_number is None and post_ms is not None:
+        # The snap ends post_ms after the trigger
+        post_s = min(post_ms / 1000.0, span_s)
+        pre_s = span_s - post_s
+        window = f"Window: -{pre_s:.3f}s to +{post_s:.3f}s ({span_s:.3f}s total)"
+        start = (snap_time - timedelta(seconds=pre_s)).strftime('%H:%M:%S.%f')[:-3]
+        end = (snap_time + timedelta(seconds=post_s)).strftime('%H:%M:%S.%f')[:-3]
+    else:
+        where = f" around hit {hit_number}" if hit_number is not None else ""
+        window = f"Window: {span_s:.3f}s total{where}"
+        start = f"{first_ms:.3f} ms (device)"
+        end = f"{last_ms:.3f} ms (device)"
+
+    with open(snap_path, 'w') as sf:
+        # Header metadata matching original format
+        sf.write("===SEEs SNAP START===\n")
+        sf.write(f"Trigger time: {snap_time.strftime('%Y%m%d %H:%M:%S.%f')[:-3]}\n")
+        sf.write(window + "\n")
+        sf.write(f"Start: {start}\n")
+        sf.write(f"End:   {end}\n")
+        sf.write(f"Frames: {len(snap_data)}\n")
+        # Layer hit summary
+        sf.write(f"1:{layer_counts[1]} 2:{layer_counts[2]} 3:{layer_counts[3]} 4:{layer_counts[4]}\n")
+        sf.write("Layer 1: ~0.25V | Layer 2: ~0.40V | Layer 3: ~0.55V | Layer 4: ~0.70V [[Proton]]\n")
+        sf.write("time_ms,voltage_V,hit,total_hits\n")
+        for sample in snap_data:
+            sf.write(sample + '\n')
+    sys.stdout.write(f"\r\033[K✅ Snap saved: {snap_filename} ({len(snap_data)} samples, {hits} hits)\n")
+    sys.stdout.write(f"   Layers: 1:{layer_counts[1]} 2:{layer_counts[2]} 3:{layer_counts[3]} 4:{layer_counts[4]}\n")
+    sys.stdout.flush()
+
+
 def interactive_console(port, verbose=False, native_bin=None, data_port=None):
     """Interactive console - logs stream and forwards commands to Teensy
 
@@ -307,6 +428,32 @@ def interactive_console(port, verbose=False, native_bin=None, data_port=None):
     stream_file = open(stream_file_path, 'w', buffering=1)
     stream_file.write("time_ms,voltage_V,hit,total_hits\n")
 
+    # Coincidence file is only created once a multi-layer detector reports one
+    coinc_file = None
+
+    def record_coincidence(coinc):
+        nonlocal coinc_file
+        if coinc_file is None:
+            coinc_file = open(session_dir / generate_coinc_filename(session_timestamp),
+                              'w', buffering=1)
+            coinc_file.write(COINC_CSV_HEADER + '\n')
+        coinc_file.write(format_coincidence(coinc) + '\n')
+        sys.stdout.write(f"\r\033[K[coinc] depth {coinc.depth} at {coinc.time_ms:.3f} ms "
+                         f"(layers 0x{coinc.layer_mask:x}, spread {coinc.spread_us} us)\n")
+        sys.stdout.flush()
+
+    # Every build sends a pulse peak histogram per integration window
+    hist_file = open(session_dir / generate_hist_filename(session_timestamp), 'w', buffering=1)
+    hist_file.write(HIST_CSV_HEADER + '\n')
+
+    # One pulse record (peak, integral, rise, duration) per hit
+    pulse_file = open(session_dir / generate_pulse_filename(session_timestamp), 'w', buffering=1)
+    pulse_file.write(PULSE_CSV_HEADER + '\n')
+
+    # Live/dead time and missed sample slots, one row per layer every 10 s
+    stats_file = open(session_dir / generate_stats_filename(session_timestamp), 'w', buffering=1)
+    stats_file.write(STATS_CSV_HEADER + '\n')
+
     # State tracking
     snap_count = 0
     data_streaming = False
@@ -317,10 +464,16 @@ def interactive_console(port, verbose=False, native_bin=None, data_port=None):
     capturing_snap = False
     snap_data = []
     snap_trigger_time = None
+    snap_post_ms = None
+    snap_hit = None
 
     # Line buffer for processing complete lines
     line_buffer = ""
 
+    # Splits binary stream frames out of the serial byte stream
+    frame_decoder = FrameDecoder()
+    snap_assembler = SnapAssembler()
+
     # Input buffer for tracking what user is typing
     input_buffer = ""
 
@@ -367,8 +520,10 @@ def interactive_console(port, verbose=False, native_bin=None, data_port=None):
                         sys.stdout.write('\n')
                     # Capture timestamp when sending snap command (for synced filenames)
                     cmd = input_buffer.strip().lower()
-                    if cmd == 'snap':
+                    if cmd == 'snap' or cmd.startswith('snap '):
                         snap_trigger_time = datetime.now()
+                        snap_post_ms = None
+                        snap_hit = None
                     input_buffer = ""
                 elif char == '\x7f':  # Backspace
                     if input_buffer:
@@ -385,6 +540,64 @@ def interactive_console(port, verbose=False, native_bin=None, data_port=None):
             # Check for serial data from Teensy
             if ser.in_waiting > 0:
                 data = ser.read(ser.in_waiting)
+
+                # Binary stream frames -> same CSV rows as text mode
+                data, frames = frame_decoder.feed(data)
+                for frame in frames:
+                    # Binary snap export -> same snap file as the CSV dump
+                    if frame.type in SNAP_FRAME_TYPES:
+                        rows = snap_assembler.feed(frame)
+                        if rows:
+                            snap_count += 1
+                            snap_time = snap_trigger_time if snap_trigger_time else datetime.now()
+                            save_snap(session_dir, [format_row(r) for r in rows], snap_time,
+                                      snap_post_ms, snap_hit)
+                            if snap_assembler.end.samples_lost:
+                                sys.stdout.write(f"   ⚠️  {snap_assembler.end.samples_lost} "
+                                                 f"samples lost on device\n")
+                        continue
+                    # Event streaming: waveforms go to the stream file, summaries to the console
+                    if frame.type == FRAME_SUMMARY:
+                        summary = decode_summary(frame.payload)
+                        sys.stdout.write(f"\r\033[K[events] {summary.events} events, "
+                                         f"{summary.rate_hz:.1f} hits/s, baseline "
+                                         f"{summary.baseline_V:.4f} V ± {summary.noise_V:.4f} V, "
+                                         f"pile-up {summary.pileup_fraction:.1%}, "
+                                         f"dead {summary.dead_fraction:.1%}\n")
+                        sys.stdout.flush()
+                        continue
+                    if frame.type == FRAME_PULSE:
+                        pulse_file.write(format_pulse(decode_pulse(frame.payload)) + '\n')
+                        continue
+                    if frame.type == FRAME_HISTOGRAM:
+                        for row in histogram_rows(decode_histogram(frame.payload)):
+                            hist_file.write(format_histogram_row(row) + '\n')
+                        continue
+                    if frame.type == FRAME_STATS:
+                        for row in decode_stats(frame.payload):
+                            stats_file.write(format_stats_row(row) + '\n')
+                        continue
+                    if frame.type == FRAME_COINCIDENCE:
+                        record_coincidence(decode_coincidence(frame.payload))
+                        continue
+                    if frame.type == FRAME_EVENT:
+                        rows = decode_event(frame.payload).rows
+                    elif frame.type == FRAME_SAMPLES:
+                        rows = decode_sample_batch(frame.payload)
+                    else:
+                        continue
+                    for row in rows:
+                        row_line = format_row(row)
+                        stream_file.write(row_line + '\n')
+                        data_count += 1
+                        if verbose:
+                            sys.stdout.write(f"\r{row_line}\n")
+                    last_data_time = current_time
+                    if not verbose:
+                        data_streaming = True
+                        sys.stdout.write(f"\r\033[K[streaming... {data_count} samples (binary)]")
+                    sys.stdout.flush()
+
                 text = data.decode('utf-8', errors='ignore')
 
                 # Write to log file (always - raw serial data)
@@ -429,6 +642,14 @@ def interactive_console(port, verbose=False, native_bin=None, data_port=None):
                     if not verbose and is_data_like(line_clean):
                         continue
 
+                    # Remember where the snap sits relative to its trigger
+                    snap_wait = _SNAP_WAIT_LINE.search(line_clean)
+                    if snap_wait:
+                        snap_post_ms = int(snap_wait.group(1))
+                    snap_around = _SNAP_HIT_LINE.search(line_clean)
+                    if snap_around:
+                        snap_hit = int(snap_around.group(1))
+
                     # Handle snap responses from Teensy
                     if '[SEEs] SNAP command received' in line_clean:
                         # Note: timestamp already captured when command was SENT (not here)
@@ -448,59 +669,7 @@ def interactive_console(port, verbose=False, native_bin=None, data_port=None):
                         if capturing_snap and snap_data:
                             # Use trigger time (when snap command was sent), not end time
                             snap_time = snap_trigger_time if snap_trigger_time else datetime.now()
-                            snap_filename = f"SEEs.{snap_time.strftime('%Y%m%d.%H%M.%S')}.csv"
-                            snap_path = session_dir / snap_filename
-
-                            # Count hits and classify by layer based on voltage
-                            # Layer thresholds (midpoints between layer voltages):
-                            # 1-layer: ~0.25V, 2-layer: ~0.40V, 3-layer: ~0.55V, 4-layer: ~0.70V
-                            layer_counts = {1: 0, 2: 0, 3: 0, 4: 0}
-                            prev_hit = 0
-                            for s in snap_data:
-                                parts = s.split(',')
-                                if len(parts) >= 3:
-                                    try:
-                                        voltage = float(parts[1])
-                                        hit = int(parts[2])
-                                        # Only count on rising edge (transition from 0 to 1)
-                                        if hit == 1 and prev_hit == 0:
-                                            # Classify by voltage level
-                                            if voltage < 0.325:
-                                                layer_counts[1] += 1
-                                            elif voltage < 0.475:
-                                                layer_counts[2] += 1
-                                            elif voltage < 0.625:
-                                                layer_counts[3] += 1
-                                            else:
-                                                layer_counts[4] += 1
-                                        prev_hit = hit
-                                    except ValueError:
-                                        pass
-
-                            hits = sum(layer_counts.values())
-
-                            # Calculate start/end times (-7.5s to +2.5s from trigger)
-                            from datetime import timedelta
-                            start_time = snap_time - timedelta(seconds=7.5)
-                            end_time = snap_time + timedelta(seconds=2.5)
-
-                            with open(snap_path, 'w') as sf:
-                                # Header metadata matching original format
-                                sf.write("===SEEs SNAP START===\n")
-                                sf.write(f"Trigger time: {snap_time.strftime('%Y%m%d %H:%M:%S.%f')[:-3]}\n")
-                                sf.write("Window: -7.5s to +2.5s (10.0s total)\n")
-                                sf.write(f"Start: {start_time.strftime('%H:%M:%S.%f')[:-3]}\n")
-                                sf.write(f"End:   {end_time.strftime('%H:%M:%S.%f')[:-3]}\n")
-                                sf.write(f"Frames: {len(snap_data)}\n")
-                                # Layer hit summary
-                                sf.write(f"1:{layer_counts[1]} 2:{layer_counts[2]} 3:{layer_counts[3]} 4:{layer_counts[4]}\n")
-                                sf.write("Layer 1: ~0.25V | Layer 2: ~0.40V | Layer 3: ~0.55V | Layer 4: ~0.70V [[Proton]]\n")
-                                sf.write("time_ms,voltage_V,hit,total_hits\n")
-                                for sample in snap_data:
-                                    sf.write(sample + '\n')
-                            sys.stdout.write(f"\r\033[K✅ Snap saved: {snap_filename} ({len(snap_data)} samples, {hits} hits)\n")
-                            sys.stdout.write(f"   Layers: 1:{layer_counts[1]} 2:{layer_counts[2]} 3:{layer_counts[3]} 4:{layer_counts[4]}\n")
-                            sys.stdout.flush()
+                            save_snap(session_dir, snap_data, snap_time, snap_post_ms, snap_hit)
                         capturing_snap = False
                         snap_data = []
                         continue
@@ -514,6 +683,39 @@ def interactive_console(port, verbose=False, native_bin=None, data_port=None):
                         sys.stdout.flush()
                         continue
 
+                    # Text-mode layer coincidences -> coincidence file
+                    coinc = parse_coincidence_line(line_clean)
+                    if coinc:
+                        record_coincidence(coinc)
+                        continue
+
+                    # Text-mode pulse records -> pulse file
+                    pulse = parse_pulse_line(line_clean)
+                    if pulse:
+                        pulse_file.write(format_pulse(pulse) + '\n')
+                        if verbose:
+                            sys.stdout.write(f"\r{line_clean}\n")
+                            sys.stdout.flush()
+                        continue
+
+                    # Text-mode histogram lines -> histogram file
+                    hist_row = parse_histogram_line(line_clean)
+                    if hist_row:
+                        hist_file.write(format_histogram_row(hist_row) + '\n')
+                        if verbose:
+                            sys.stdout.write(f"\r{line_clean}\n")
+                            sys.stdout.flush()
+                        continue
+
+                    # Text-mode stats lines -> stats file
+                    stats_row = parse_stats_line(line_clean)
+                    if stats_row:
+                        stats_file.write(format_stats_row(stats_row) + '\n')
+                        if verbose:
+                            sys.stdout.write(f"\r{line_clean}\n")
+                            sys.stdout.flush()
+                        continue
+
                     # Handle [SEEs] status messages
                     if line_clean.startswith('[SEEs]'):
                         sys.stdout.write(f"\r\033[K{line_clean}\n")
@@ -546,10 +748,18 @@ def interactive_console(port, verbose=False, native_bin=None, data_port=None):
         termios.tcsetattr(sys.stdin, termios.TCSADRAIN, old_settings)
         log_file.close()
         stream_file.close()
+        hist_file.close()
+        pulse_file.close()
+        stats_file.close()
+        if coinc_file:
+            coinc_file.close()
         ser.close()
         print("\n\n✅ Session closed")
         print(f"📁 Stream saved: {session_dir}")
         print(f"   Snaps on Teensy SD: {snap_count}")
+        if frame_decoder.frames_ok:
+            print(f"   Binary frames: {frame_decoder.frames_ok} "
+                  f"(CRC errors: {frame_decoder.crc_errors}, lost: {frame_decoder.lost_frames})")
 
 
 if __name__ == "__main__":
@@ -565,8 +775,10 @@ Examples:
 Teensy streams continuously. Snaps saved to Teensy SD card.
 
 Commands:
-  snap       - Capture ±2.5s window to Teensy SD card
-  Ctrl+C     - Exit
+  snap           - Capture ±2.5s window to Teensy SD card
+  stream binary  - Switch live stream to CRC-framed binary batches
+  stream text    - Switch live stream back to CSV lines
+  Ctrl+C         - Exit
         """
     )
     parser.add_argument("port", nargs="?", default=None,
@@ -20,6 +20,9 @@ sys.path.insert(0, str(Path(__file__).parent.parent / 'scripts'))
 # Import test data generator
 from test_data_generator import ParticleDetectorSimulator
 
+import struct
+import sees_frames
+
 
 class TestDataGeneration(unittest.TestCase):
     """Test data generation for reproducibility."""
@@ -227,6 +230,294 @@ class TestEdgeCases(unittest.TestCase):
         self.assertGreater(data[-1][3], 0)
 
 
+class TestBinaryFrames(unittest.TestCase):
+    """Test binary stream frame decoding (stream binary mode)."""
+
+    def make_batch(self, t0_us, samples, total_hits):
+        padded = samples + [0] * (sees_frames.STREAM_BATCH - len(samples))
+        return struct.pack(sees_frames.SAMPLE_BATCH_FMT, t0_us, 100, len(samples),
+                           total_hits, *padded)
+
+    def test_crc_matches_firmware(self):
+        """Test CRC-16/CCITT against the standard check value."""
+        self.assertEqual(sees_frames.crc16_ccitt(b"123456789"), 0x29B1)
+
+    def test_frames_split_from_text(self):
+        """Test that frames are separated from surrounding text lines."""
+        frame = sees_frames.encode_frame(sees_frames.FRAME_SAMPLES, 7,
+                                         self.make_batch(0, [100] * 32, 0))
+        stream = b"[SEEs] Stream mode: binary\n" + frame + b"[SEEs] hello\n"
+
+        decoder = sees_frames.FrameDecoder()
+        text = b""
+        frames = []
+        for i in range(0, len(stream), 5):  # Arrive in small pieces
+            t, f = decoder.feed(stream[i:i + 5])
+            text += t
+            frames += f
+
+        self.assertEqual(text, b"[SEEs] Stream mode: binary\n[SEEs] hello\n")
+        self.assertEqual(len(frames), 1)
+        self.assertEqual(frames[0].seq, 7)
+
+    def test_corrupt_frame_rejected(self):
+        """Test that a frame with a bad CRC is dropped and counted."""
+        frame = bytearray(sees_frames.encode_frame(sees_frames.FRAME_SAMPLES, 0,
+                                                   self.make_batch(0, [1] * 32, 0)))
+        frame[20] ^= 0xFF
+        good = sees_frames.encode_frame(sees_frames.FRAME_SAMPLES, 1,
+                                        self.make_batch(3200, [2] * 32, 0))
+
+        decoder = sees_frames.FrameDecoder()
+        _, frames = decoder.feed(bytes(frame) + good)
+
+        self.assertEqual(len(frames), 1)
+        self.assertEqual(frames[0].seq, 1)
+        self.assertGreaterEqual(decoder.crc_errors, 1)
+
+    def test_lost_frames_counted(self):
+        """Test that sequence gaps are reported as lost frames."""
+        decoder = sees_frames.FrameDecoder()
+        for seq in (0, 1, 4):
+            decoder.feed(sees_frames.encode_frame(sees_frames.FRAME_SAMPLES, seq,
+                                                  self.make_batch(0, [0] * 32, 0)))
+        self.assertEqual(decoder.lost_frames, 2)
+
+    def test_sample_batch_rows(self):
+        """Test batch decoding reproduces the text stream columns."""
+        hit = sees_frames.SAMPLE_HIT_BIT
+        samples = [124, 372 | hit, 500, 124 | hit]
+        rows = sees_frames.decode_sample_batch(self.make_batch(1000, samples, 12))
+
+        self.assertEqual(len(rows), 4)
+        self.assertEqual(sees_frames.format_row(rows[0]), "1.000,0.0999,0,10")
+        self.assertEqual(rows[1][2:], (1, 11))
+        self.assertAlmostEqual(rows[2][0], 1.2)
+        self.assertEqual(rows[3][2:], (1, 12))
+
+
+class TestSampleCodec(unittest.TestCase):
+    """Test the compressed buffer block codec (SampleCodec.hpp)."""
+
+    ADC = [124, 126, 121, 121, 900, 130, 124, 125]
+    HITS = [0, 0, 0, 0, 1, 0, 0, 0]
+    DELTAS = [250, 100, 100, 100, 100, 100, 7, 100]
+
+    # sees_block_encode() output for the samples above
+    FIRMWARE_BLOCK = bytes.fromhex("070b01007c00640002000400fa00060700044800002c3ce0050800")
+
+    def test_matches_firmware_encoding(self):
+        """Test that the host encoder is byte-identical to the firmware."""
+        block = sees_frames.encode_sample_block(self.ADC, self.HITS, self.DELTAS, 100)
+        self.assertEqual(block, self.FIRMWARE_BLOCK)
+
+    def test_decode_firmware_block(self):
+        """Test decoding a firmware block back to samples, hits and deltas."""
+        adc, hits, deltas, size = sees_frames.decode_sample_block(self.FIRMWARE_BLOCK + b"\0\0")
+        self.assertEqual(adc, self.ADC)
+        self.assertEqual(hits, self.HITS)
+        self.assertEqual(deltas, self.DELTAS)
+        self.assertEqual(size, len(self.FIRMWARE_BLOCK))
+
+    def test_hit_bitset_roundtrip(self):
+        """Test a full block with many hits (bitset mode) and extreme values."""
+        adc = [0, 4095] * 128
+        hits = [i % 2 for i in range(256)]
+        deltas = [100] * 255 + [65535]
+        block = sees_frames.encode_sample_block(adc, hits, deltas, 100)
+        self.assertEqual(block[2], sees_frames.BLOCK_HIT_BITSET)
+        self.assertEqual(sees_frames.decode_sample_block(block)[:3], (adc, hits, deltas))
+
+    def test_flat_baseline_compresses(self):
+        """Test that a constant baseline needs no delta bits."""
+        block = sees_frames.encode_sample_block([124] * 256, [0] * 256, [100] * 256, 100)
+        self.assertEqual(len(block), sees_frames.BLOCK_HEADER_SIZE)
+
+
+class TestBinarySnap(unittest.TestCase):
+    """Test rebuilding a binary snap export into CSV snap rows."""
+
+    def frame(self, ftype, fmt, *fields, block=b""):
+        return sees_frames.Frame(ftype, 0, struct.pack(fmt, *fields) + block)
+
+    def data(self, first, first_us, adc, hits, deltas):
+        block = sees_frames.encode_sample_block(adc, hits, deltas, 100)
+        return self.frame(sees_frames.FRAME_SNAP_DATA, sees_frames.SNAP_DATA_FMT, 1, first,
+                          first_us, block=block)
+
+    def header(self, count):
+        return self.frame(sees_frames.FRAME_SNAP_HEADER, sees_frames.SNAP_HEADER_FMT,
+                          1, count, 5000000, 100, 12, 0, 3.3)
+
+    def end(self, sent, lost, hits):
+        return self.frame(sees_frames.FRAME_SNAP_END, sees_frames.SNAP_END_FMT, 1, sent, lost, hits)
+
+    def test_rows_match_csv_snap(self):
+        """Test time, voltage and running hit columns match the CSV dump."""
+        asm = sees_frames.SnapAssembler()
+        self.assertIsNone(asm.feed(self.header(4)))
+        self.assertIsNone(asm.feed(self.data(0, 0, [124, 372, 124], [0, 1, 0], [0, 100, 100])))
+        self.assertIsNone(asm.feed(self.data(3, 450, [500], [1], [0])))
+        rows = asm.feed(self.end(4, 0, 2))
+
+        lines = [sees_frames.format_row(r) for r in rows]
+        self.assertEqual(lines, ["0.000,0.0999,0,0", "0.100,0.2998,1,1",
+                                 "0.200,0.0999,0,1", "0.450,0.4029,1,2"])
+
+    def test_lost_samples_bridged(self):
+        """Test that samples overwritten on the device keep later times aligned."""
+        asm = sees_frames.SnapAssembler()
+        asm.feed(self.header(10))
+        asm.feed(self.data(0, 0, [124, 124], [0, 0], [0, 100]))
+        asm.feed(self.data(8, 800, [124, 124], [0, 0], [0, 100]))
+        rows = asm.feed(self.end(4, 6, 0))
+
+        self.assertEqual([round(r[0], 3) for r in rows], [0.0, 0.1, 0.8, 0.9])
+        self.assertEqual(asm.end.samples_lost, 6)
+
+    def test_long_gap_from_block_start(self):
+        """Test that a gap too long for a 16-bit delta is taken from the block's first_us."""
+        asm = sees_frames.SnapAssembler()
+        asm.feed(self.header(4))
+        asm.feed(self.data(0, 0, [124, 124], [0, 0], [0, 100]))
+        asm.feed(self.data(2, 250100, [124, 124], [0, 0], [0, 100]))
+        rows = asm.feed(self.end(4, 0, 0))
+
+        self.assertEqual([round(r[0], 3) for r in rows], [0.0, 0.1, 250.1, 250.2])
+
+    def test_data_without_header_ignored(self):
+        """Test that frames from a snap whose header was missed are dropped."""
+        asm = sees_frames.SnapAssembler()
+        self.assertIsNone(asm.feed(self.data(0, 0, [1], [0], [0])))
+        self.assertIsNone(asm.feed(self.end(1, 0, 0)))
+
+
+class TestEventStream(unittest.TestCase):
+    """Test decoding zero-suppressed event and summary frames."""
+
+    def test_event_rows(self):
+        """Test that an event waveform decodes to stream rows with running hits."""
+        samples = [124, 372 | sees_frames.SAMPLE_HIT_BIT, 200]
+        payload = struct.pack(sees_frames.EVENT_HEADER_FMT, 7, 1000, 100, 3, 1, 1, 5)
+        payload += struct.pack('<3H', *samples)
+        event = sees_frames.decode_event(payload)
+
+        self.assertEqual(event.event_id, 7)
+        self.assertEqual(event.trigger_index, 1)
+        lines = [sees_frames.format_row(r) for r in event.rows]
+        self.assertEqual(lines, ["1.000,0.0999,0,4", "1.100,0.2998,1,5", "1.200,0.1612,0,5"])
+
+    def test_summary_rate_and_baseline(self):
+        """Test that a summary reports the hit rate and baseline in volts."""
+        payload = struct.pack(sees_frames.SUMMARY_FMT, 2000000, 500000, 5000, 3, 10, 2,
+                              124.0, 4.0)
+        summary = sees_frames.decode_summary(payload)
+
+        self.assertAlmostEqual(summary.rate_hz, 6.0)
+        self.assertAlmostEqual(summary.baseline_V, 0.0999, places=4)
+        self.assertAlmostEqual(summary.noise_V, 0.0032, places=4)
+        self.assertEqual(summary.events, 2)
+        self.assertEqual(summary.pileups, 0)
+
+    def test_summary_pileup_and_dead_time(self):
+        """Test that a summary reports the pile-up and dead-time fractions."""
+        payload = struct.pack(sees_frames.SUMMARY_FMT, 2000000, 500000, 5000, 3, 10, 2,
+                              124.0, 4.0)
+        payload += struct.pack(sees_frames.SUMMARY_PILEUP_FMT, 1, 50000)
+        summary = sees_frames.decode_summary(payload)
+
+        self.assertAlmostEqual(summary.pileup_fraction, 0.25)
+        self.assertAlmostEqual(summary.dead_fraction, 0.1)
+
+
+class TestCoincidence(unittest.TestCase):
+    """Test decoding layer coincidence records."""
+
+    def test_frame_and_text_agree(self):
+        """Test that binary and text-mode coincidences decode to the same row."""
+        frame = sees_frames.decode_coincidence(
+            struct.pack(sees_frames.COINC_FMT, 1342500, 100, 0b0111, 3))
+        text = sees_frames.parse_coincidence_line(
+            "[SEEs] Coincidence at 1342.500 ms: depth 3, layers 0+1+2, spread 100 us")
+
+        self.assertEqual(frame, text)
+        self.assertEqual(sees_frames.format_coincidence(frame), "1342.500,3,7,100")
+
+    def test_status_lines_ignored(self):
+        """Test that other status lines are not taken for coincidences."""
+        self.assertIsNone(sees_frames.parse_coincidence_line("[SEEs] Coincidences (window 100 us):"))
+        self.assertIsNone(sees_frames.parse_coincidence_line("12.300,0.1000,0,4"))
+
+
+class TestHistogram(unittest.TestCase):
+    """Test decoding pulse peak histograms."""
+
+    def test_frame_and_text_agree(self):
+        """Test that a histogram frame and the text-mode lines give the same rows."""
+        counts = [0] * (sees_frames.HIST_LAYERS * sees_frames.HIST_BINS)
+        counts[2] = 3
+        counts[8] = 4
+        counts[15] = 65535
+        payload = struct.pack(sees_frames.HIST_FMT, 10000000, 5000000, 2, 8, 372, 78, *counts)
+        hist = sees_frames.decode_histogram(payload)
+        rows = sees_frames.histogram_rows(hist)
+
+        self.assertEqual(len(rows), 2)
+        self.assertAlmostEqual(hist.min_V, 0.2998, places=4)
+        self.assertEqual(rows[1].counts, [4, 0, 0, 0, 0, 0, 0, 65535])
+        text = sees_frames.parse_histogram_line(
+            "[SEEs] Histogram at 10000.000 ms (5000 ms), layer 1: 4 0 0 0 0 0 0 65535")
+        self.assertEqual(text, rows[1])
+        self.assertEqual(sees_frames.format_histogram_row(text),
+                         "10000.000,5000,1,4,0,0,0,0,0,0,65535")
+
+
+class TestPulseRecords(unittest.TestCase):
+    """Test decoding per-hit pulse records."""
+
+    def test_frame_and_text_agree(self):
+        """Test that a pulse frame and the text-mode line decode to the same record."""
+        payload = struct.pack(sees_frames.PULSE_FMT, 1381100, 4950, 592, 141, 200, 1100, 2, 2)
+        frame = sees_frames.decode_pulse(payload)
+        text = sees_frames.parse_pulse_line(
+            "[SEEs] Pulse layer 2 at 1381.100 ms: peak 592, pedestal 141, integral 4950, "
+            "rise 200 us, duration 1100 us, peaks 2")
+
+        self.assertEqual(frame, text)
+        self.assertEqual(sees_frames.format_pulse(frame),
+                         "1381.100,2,0.4771,0.1136,4950,200,1100,2")
+
+    def test_records_without_peaks(self):
+        """Test that records from firmware without pile-up detection read as one peak."""
+        payload = struct.pack(sees_frames.PULSE_FMT, 1381100, 4950, 592, 141, 200, 1100, 2, 0)
+        text = sees_frames.parse_pulse_line(
+            "[SEEs] Pulse layer 2 at 1381.100 ms: peak 592, pedestal 141, integral 4950, "
+            "rise 200 us, duration 1100 us")
+
+        self.assertEqual(sees_frames.decode_pulse(payload).peaks, 1)
+        self.assertEqual(text.peaks, 1)
+
+
+class TestStats(unittest.TestCase):
+    """Test decoding dead/live time records."""
+
+    def test_frame_and_text_agree(self):
+        """Test that a stats frame and the text-mode lines decode to the same rows."""
+        payload = struct.pack(sees_frames.STATS_FMT, 9999900, 10000000, 99000, 1000, 400, 3,
+                              145, 2, 0, 11, 2, 0, 0, 10500, 600, 0, 0, 7)
+        rows = sees_frames.decode_stats(payload)
+        text = [sees_frames.parse_stats_line(
+                    f"[SEEs] Stats at 9999.900 ms (10000 ms), layer {layer}: slots 99000, "
+                    f"lost 1000 (400 in snaps), overruns 3, backlog 145, dt dropped 7, hits {hits}, "
+                    f"dead {dead} us, live 98.895%")
+                for layer, hits, dead in ((0, 11, 10500), (1, 2, 600))]
+
+        self.assertEqual(rows, text)
+        self.assertAlmostEqual(rows[0].live, 1.0 - (10500 + 100000) / 10000000)
+        self.assertEqual(sees_frames.format_stats_row(rows[1]),
+                         "9999.900,10000,1,99000,1000,400,3,145,7,2,600,0.98994")
+
+
 class CompactTestResult(unittest.TextTestResult):
     """Custom test result that shows short descriptions."""
 